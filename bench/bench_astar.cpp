@@ -0,0 +1,88 @@
+/**
+ * @file bench_astar.cpp
+ * @brief Queries per second of A* Search with the indexed heap open list, against the original
+ *  open list that was fully sorted before every expansion.
+ *
+ * Usage: bench_astar [map.osm] [queries]
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "bench_util.h"
+#include "mapping/route_model.h"
+#include "routing/route_planner.h"
+
+using rideshare::RouteModel;
+
+// The original search: every neighbor not yet visited is pushed with its f-value (no decrease-key),
+//  and the whole open list is sorted to pop the lowest one
+static int SortedListSearch(const RouteModel &model, int start_idx, int end_idx) {
+    const std::vector<RouteModel::Node> &nodes = model.SNodes();
+    std::vector<float> g_values(nodes.size(), 0.0);
+    std::vector<float> f_values(nodes.size(), 0.0);
+    std::vector<int> parents(nodes.size(), -1);
+    std::vector<char> visited(nodes.size(), false);
+    std::vector<int> open_list = {start_idx};
+    visited[start_idx] = true;
+    while (!open_list.empty()) {
+        std::sort(open_list.begin(), open_list.end(), [&](int a, int b) { return f_values[a] > f_values[b]; });
+        int current = open_list.back();
+        open_list.pop_back();
+        if (current == end_idx) {
+            int length = 1;
+            for (int idx = current; parents[idx] != -1; idx = parents[idx]) {
+                ++length;
+            }
+            return length;
+        }
+        for (int edge = model.EdgeOffsets()[current]; edge < model.EdgeOffsets()[current + 1]; ++edge) {
+            int next = model.EdgeTargets()[edge];
+            if (visited[next]) {
+                continue;
+            }
+            visited[next] = true;
+            parents[next] = current;
+            g_values[next] = g_values[current] + model.EdgeLengths()[edge];
+            f_values[next] = g_values[next] + nodes[next].Distance(nodes[end_idx]);
+            open_list.emplace_back(next);
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    RouteModel model = rideshare::bench::LoadModel(argc, argv);
+    int query_count = rideshare::bench::IntArg(argc, argv, 2, 2000);
+    auto queries = rideshare::bench::RandomQueries(model, query_count);
+
+    long sorted_nodes = 0;
+    double sorted_seconds = rideshare::bench::Seconds([&]() {
+        for (const auto &[start, dest] : queries) {
+            sorted_nodes += SortedListSearch(model, model.FindClosestNode(start).Index(),
+                                             model.FindClosestNode(dest).Index());
+        }
+    });
+
+    rideshare::RoutePlanner route_planner(model);
+    std::vector<int> path;
+    long heap_nodes = 0;
+    double heap_seconds = rideshare::bench::Seconds([&]() {
+        for (const auto &[start, dest] : queries) {
+            route_planner.AStarSearch(start, dest, path);
+            heap_nodes += path.size();
+        }
+    });
+
+    std::cout << model.SNodes().size() << " nodes, " << query_count << " queries" << std::endl;
+    std::cout << "sorted open list: " << query_count / sorted_seconds << " queries/s ("
+              << (double)sorted_nodes / query_count << " path nodes avg.)" << std::endl;
+    std::cout << "indexed heap:     " << query_count / heap_seconds << " queries/s ("
+              << (double)heap_nodes / query_count << " path nodes avg.)" << std::endl;
+    std::cout << "speedup: " << sorted_seconds / heap_seconds << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file bench_closest_node.cpp
+ * @brief Closest road node lookups through the RouteModel spatial grid, against a linear scan of every node.
+ *
+ * Usage: bench_closest_node [map.osm] [lookups]
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "bench_util.h"
+#include "mapping/coordinate.h"
+#include "mapping/route_model.h"
+
+using rideshare::Coordinate;
+using rideshare::RouteModel;
+
+// Check every node in the given component, as the lookup did before the grid
+static const RouteModel::Node &ScanClosestNode(const RouteModel &model, int component, const Coordinate &coordinate) {
+    RouteModel::Node input;
+    input.x = coordinate.x;
+    input.y = coordinate.y;
+    const RouteModel::Node *closest = nullptr;
+    float min_dist = std::numeric_limits<float>::max();
+    for (const RouteModel::Node &node : model.SNodes()) {
+        float dist = input.Distance(node);
+        if (dist < min_dist && model.Component(node.Index()) == component) {
+            closest = &node;
+            min_dist = dist;
+        }
+    }
+    return *closest;
+}
+
+int main(int argc, char *argv[]) {
+    RouteModel model = rideshare::bench::LoadModel(argc, argv);
+    int lookup_count = rideshare::bench::IntArg(argc, argv, 2, 100000);
+    std::vector<Coordinate> positions;
+    for (const auto &[start, dest] : rideshare::bench::RandomQueries(model, lookup_count / 2)) {
+        positions.emplace_back(start);
+        positions.emplace_back(dest);
+    }
+    // The grid only holds the main component, so scan only it too
+    int main_component = model.Component(model.FindClosestNode(positions[0]).Index());
+
+    std::vector<int> scan_found;
+    double scan_seconds = rideshare::bench::Seconds([&]() {
+        for (const Coordinate &position : positions) {
+            scan_found.emplace_back(ScanClosestNode(model, main_component, position).Index());
+        }
+    });
+    std::vector<int> grid_found;
+    double grid_seconds = rideshare::bench::Seconds([&]() {
+        for (const Coordinate &position : positions) {
+            grid_found.emplace_back(model.FindClosestNode(position).Index());
+        }
+    });
+
+    // Ties may pick different nodes, so compare distances
+    int mismatches = 0;
+    for (std::size_t i = 0; i < positions.size(); ++i) {
+        const RouteModel::Node &scanned = model.SNodes()[scan_found[i]];
+        const RouteModel::Node &gridded = model.SNodes()[grid_found[i]];
+        RouteModel::Node input;
+        input.x = positions[i].x;
+        input.y = positions[i].y;
+        mismatches += input.Distance(scanned) != input.Distance(gridded);
+    }
+
+    std::cout << model.SNodes().size() << " nodes, " << positions.size() << " lookups" << std::endl;
+    std::cout << "linear scan:  " << 1e9 * scan_seconds / positions.size() << " ns/lookup" << std::endl;
+    std::cout << "spatial grid: " << 1e9 * grid_seconds / positions.size() << " ns/lookup" << std::endl;
+    std::cout << "speedup: " << scan_seconds / grid_seconds << "x, " << mismatches << " different results" << std::endl;
+    return 0;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file bench_fleet.cpp
+ * @brief Per-cycle vehicle movement and position scans over the structure-of-arrays VehicleFleet,
+ *  against the original layout of one heap-allocated vehicle object per id in a hash map.
+ *
+ * Usage: bench_fleet [map.osm] [cycles]
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_util.h"
+#include "mapping/coordinate.h"
+#include "mapping/route_model.h"
+#include "map_object/map_object.h"
+#include "map_object/passenger.h"
+#include "map_object/vehicle_fleet.h"
+#include "routing/route_planner.h"
+
+using rideshare::Coordinate;
+using rideshare::RouteModel;
+
+// The original vehicle: its own allocation with a virtual move, reached through a shared pointer
+class ReferenceVehicle : public rideshare::MapObject {
+  public:
+    ReferenceVehicle(const RouteModel *model, double distance_per_cycle) : MapObject(distance_per_cycle), model_(model) {}
+
+    rideshare::VehicleState State() { return state_; }
+
+    void IncrementalMove() override {
+        const RouteModel::Node &next_pos = model_->SNodes()[path_.at(path_index_)];
+        double distance = std::sqrt(std::pow(next_pos.x - position_.x, 2) + std::pow(next_pos.y - position_.y, 2));
+        if (distance <= distance_per_cycle_) {
+            position_ = (Coordinate){.x = next_pos.x, .y = next_pos.y};
+            ++path_index_;
+        } else {
+            position_ = GetIntermediatePosition(next_pos.x, next_pos.y);
+        }
+        if (passenger_ != nullptr) {
+            passenger_->SetPosition(position_);
+        }
+    }
+
+  private:
+    const RouteModel *model_;
+    rideshare::VehicleState state_ = rideshare::VehicleState::no_passenger_requested;
+    int path_index_ = 0;
+    std::shared_ptr<rideshare::Passenger> passenger_;
+};
+
+int main(int argc, char *argv[]) {
+    RouteModel model = rideshare::bench::LoadModel(argc, argv);
+    int cycles = rideshare::bench::IntArg(argc, argv, 2, 20);
+    double distance_per_cycle = std::abs(model.MaxLat() - model.MinLat()) / 1000.0;
+
+    // Hand out a small set of routes, each long enough to keep moving for every cycle
+    rideshare::RoutePlanner route_planner(model);
+    std::vector<std::vector<int>> routes;
+    for (const auto &[start, dest] : rideshare::bench::RandomQueries(model, 1000)) {
+        std::vector<int> path;
+        route_planner.AStarSearch(start, dest, path);
+        if ((int)path.size() > cycles) {
+            routes.emplace_back(std::move(path));
+        }
+        if (routes.size() == 64) {
+            break;
+        }
+    }
+    if (routes.empty()) {
+        std::cerr << "No routes longer than " << cycles << " nodes on this map" << std::endl;
+        return 1;
+    }
+    auto node_position = [&](int idx) {
+        return (Coordinate){.x = model.SNodes()[idx].x, .y = model.SNodes()[idx].y};
+    };
+
+    for (int vehicle_count : {10000, 100000}) {
+        rideshare::VehicleFleet fleet(&model, distance_per_cycle);
+        std::unordered_map<int, std::shared_ptr<ReferenceVehicle>> vehicles;
+        for (int id = 0; id < vehicle_count; ++id) {
+            const std::vector<int> &route = routes[id % routes.size()];
+            int slot = fleet.Add(id, node_position(route.front()), node_position(route.back()));
+            fleet.SetPath(slot, route);
+            auto vehicle = std::make_shared<ReferenceVehicle>(&model, distance_per_cycle);
+            vehicle->SetId(id);
+            vehicle->SetPosition(node_position(route.front()));
+            vehicle->SetDestination(node_position(route.back()));
+            vehicle->SetPath(route);
+            vehicles.emplace(id, vehicle);
+        }
+
+        double map_move = rideshare::bench::Seconds([&]() {
+            for (int cycle = 0; cycle < cycles; ++cycle) {
+                for (auto &[id, vehicle] : vehicles) {
+                    if (vehicle->State() != rideshare::VehicleState::waiting) {
+                        vehicle->IncrementalMove();
+                    }
+                }
+            }
+        });
+        double fleet_move = rideshare::bench::Seconds([&]() {
+            for (int cycle = 0; cycle < cycles; ++cycle) {
+                for (int slot = 0; slot < fleet.Size(); ++slot) {
+                    if (fleet.State(slot) != rideshare::VehicleState::waiting) {
+                        fleet.IncrementalMove(slot);
+                    }
+                }
+            }
+        });
+        double map_sum = 0.0;
+        double map_scan = rideshare::bench::Seconds([&]() {
+            for (int cycle = 0; cycle < cycles; ++cycle) {
+                for (auto &[id, vehicle] : vehicles) {
+                    map_sum += vehicle->GetPosition().x;
+                }
+            }
+        });
+        double fleet_sum = 0.0;
+        double fleet_scan = rideshare::bench::Seconds([&]() {
+            for (int cycle = 0; cycle < cycles; ++cycle) {
+                for (int slot = 0; slot < fleet.Size(); ++slot) {
+                    fleet_sum += fleet.Position(slot).x;
+                }
+            }
+        });
+
+        // Both moved the same vehicles the same way, so the positions should add up the same
+        std::cout << vehicle_count << " vehicles, " << cycles << " cycles"
+                  << (std::abs(map_sum - fleet_sum) > 1e-6 * std::abs(map_sum) ? " (positions differ!)" : "") << std::endl;
+        std::cout << "  move cycle:    " << 1e3 * map_move / cycles << " ms hash map, "
+                  << 1e3 * fleet_move / cycles << " ms fleet" << std::endl;
+        std::cout << "  position scan: " << 1e3 * map_scan / cycles << " ms hash map, "
+                  << 1e3 * fleet_scan / cycles << " ms fleet" << std::endl;
+    }
+    return 0;
+}
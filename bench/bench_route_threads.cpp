@@ -0,0 +1,53 @@
+/**
+ * @file bench_route_threads.cpp
+ * @brief Queries per second of a single shared RoutePlanner as the number of threads searching it grows.
+ *
+ * Usage: bench_route_threads [map.osm] [queries] [max threads, default all hardware threads]
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+#include "mapping/route_model.h"
+#include "routing/route_planner.h"
+
+int main(int argc, char *argv[]) {
+    rideshare::RouteModel model = rideshare::bench::LoadModel(argc, argv);
+    int query_count = rideshare::bench::IntArg(argc, argv, 2, 20000);
+    auto queries = rideshare::bench::RandomQueries(model, query_count);
+    rideshare::RoutePlanner route_planner(model);
+    int max_threads = rideshare::bench::IntArg(argc, argv, 3, std::max(1u, std::thread::hardware_concurrency()));
+
+    std::cout << model.SNodes().size() << " nodes, " << query_count << " queries" << std::endl;
+    double single_thread_rate = 0.0;
+    for (int thread_count = 1; thread_count <= max_threads; thread_count *= 2) {
+        // Each thread takes every thread_count-th query, re-using its own path
+        double seconds = rideshare::bench::Seconds([&]() {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < thread_count; ++t) {
+                threads.emplace_back([&, t]() {
+                    std::vector<int> path;
+                    for (int i = t; i < query_count; i += thread_count) {
+                        route_planner.AStarSearch(queries[i].first, queries[i].second, path);
+                    }
+                });
+            }
+            for (std::thread &thread : threads) {
+                thread.join();
+            }
+        });
+        double rate = query_count / seconds;
+        if (thread_count == 1) {
+            single_thread_rate = rate;
+        }
+        std::cout << thread_count << " threads: " << rate << " queries/s (" << rate / single_thread_rate
+                  << "x)" << std::endl;
+    }
+    return 0;
+}
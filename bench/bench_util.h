@@ -0,0 +1,67 @@
+/**
+ * @file bench_util.h
+ * @brief Shared helpers for the benchmark executables.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef BENCH_UTIL_H_
+#define BENCH_UTIL_H_
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mapping/coordinate.h"
+#include "mapping/route_model.h"
+
+namespace rideshare {
+namespace bench {
+
+// Map used when none is given, relative to the build directory like the simulator's own data files
+static const std::string DEFAULT_MAP = "../data/downtown-kc.osm";
+
+// Read the OSM map given as the first argument, or the default map
+inline RouteModel LoadModel(int argc, char *argv[]) {
+    std::string osm_data_file = (argc > 1) ? argv[1] : DEFAULT_MAP;
+    std::ifstream osm_data{osm_data_file, std::ios::binary};
+    if (!osm_data) {
+        std::cerr << "Failed to read " << osm_data_file << std::endl;
+        std::exit(1);
+    }
+    return RouteModel{osm_data};
+}
+
+// Integer argument at the given position, or a default if not given
+inline int IntArg(int argc, char *argv[], int position, int default_value) {
+    return (argc > position) ? std::atoi(argv[position]) : default_value;
+}
+
+// Random start / destination pairs along the map's roads, the same on every run
+inline std::vector<std::pair<Coordinate, Coordinate>> RandomQueries(const RouteModel &model, int count) {
+    std::srand(1);
+    std::vector<std::pair<Coordinate, Coordinate>> queries;
+    for (int i = 0; i < count; ++i) {
+        Coordinate start = model.GetRandomMapPosition();
+        queries.emplace_back(start, model.GetRandomMapPosition());
+    }
+    return queries;
+}
+
+// Wall clock seconds taken to run a function
+template <typename Function>
+double Seconds(Function function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace bench
+}  // namespace rideshare
+
+#endif  // BENCH_UTIL_H_
@@ -23,8 +23,14 @@ std::unordered_map<std::string, std::string> SimpleParser::ParseArgs(int argc, c
     for (int i = 0; i < argc; ++i) {
         if (argv[i] == std::string("-h")) {
             PrintHelper();
+        } else if (argv[i] == std::string("--compile-map")) {
+            settings["compile_map"] = "true";
+        } else if (argv[i] == std::string("--headless")) {
+            settings["headless"] = "true";
         } else if (argv[i][0] == '-' && (i+1 >= argc)) {
             MissingArgValue(argv[i]);
+        } else if (argv[i] == std::string("-a")) {
+            settings["algorithm"] = ParseRouteAlgorithm(argv[i+1]);
         } else if (argv[i] == std::string("-m")) {
             settings["map"] = argv[i+1];
         } else if (argv[i] == std::string("-p")) {
@@ -33,6 +39,9 @@ std::unordered_map<std::string, std::string> SimpleParser::ParseArgs(int argc, c
         } else if (argv[i] == std::string("-r")) {
             ParseNumericInputs(argv[i+1], "Wait Range", ABSOLUTE_MIN_WAIT_RANGE, ABSOLUTE_MAX_OBJECTS);
             settings["wait_range"] = argv[i+1];
+        } else if (argv[i] == std::string("-s")) {
+            ParseNumericInputs(argv[i+1], "Simulated Seconds", ABSOLUTE_MIN_SIM_SECONDS, ABSOLUTE_MAX_SIM_SECONDS);
+            settings["sim_seconds"] = argv[i+1];
         } else if (argv[i] == std::string("-t")) {
             settings["match"] = ParseMatchType(argv[i+1]);
         } else if (argv[i] == std::string("-v")) {
@@ -58,13 +67,26 @@ std::string SimpleParser::ParseMatchType(std::string input_match) {
         ch = tolower(ch);
     }
     // Make sure it is a valid type
-    if (input_match != "closest" && input_match != "simple") {
+    if (input_match != "closest" && input_match != "simple" && input_match != "batch") {
         std::cout << "Invalid match type given." << std::endl;
         PrintHelper();
     }
     return input_match;
 }
 
+std::string SimpleParser::ParseRouteAlgorithm(std::string input_algorithm) {
+    // Make lowercase
+    for (auto& ch : input_algorithm) {
+        ch = tolower(ch);
+    }
+    // Make sure it is a valid algorithm
+    if (input_algorithm != "astar" && input_algorithm != "alt" && input_algorithm != "bidir" && input_algorithm != "ch") {
+        std::cout << "Invalid route algorithm given." << std::endl;
+        PrintHelper();
+    }
+    return input_algorithm;
+}
+
 void SimpleParser::ParseNumericInputs(std::string max_objects, std::string name, int min, int max) {
     // Check that it is a number
     try {
@@ -83,13 +105,23 @@ void SimpleParser::ParseNumericInputs(std::string max_objects, std::string name,
 void SimpleParser::PrintHelper() {
     std::cout << "Rideshare Simulation - Valid Arguments" << std::endl;
     std::cout << "-h : Display this helper text. Program will exit." << std::endl;
+    std::cout << "-a : Route algorithm, 'astar', 'alt' (A* with landmark distances), 'bidir' (A* from both ends)"
+      << " or 'ch' (contraction hierarchies, built once and then read from a file in /data dir).  Default: "
+      << DEFAULT_ALGORITHM << std::endl;
+    std::cout << "--compile-map : Write the map's processed road graph to a binary file in /data dir"
+      << " for faster loading on later runs. Program will exit." << std::endl;
+    std::cout << "--headless : Run without graphics on a virtual clock for the simulated seconds from -s"
+      << " (one hour if not given), then print a summary. Program will exit." << std::endl;
     std::cout << "-m : Map data file and image name, in /data dir.  Default: "
       << DEFAULT_MAP << std::endl;
     std::cout << "-p : Max passengers in queue.  Min: 0  Max: "
       << ABSOLUTE_MAX_OBJECTS << "  Default: " << DEFAULT_MAX_OBJECTS << std::endl;
     std::cout << "-r : Range, on top of min, to wait to generate passenger.  Min: "
       << ABSOLUTE_MIN_WAIT_RANGE << "  Default: " << DEFAULT_WAIT_RANGE << std::endl;
-    std::cout << "-t : Match type, either 'closest' or 'simple'.  Default: "
+    std::cout << "-s : Run a discrete-event simulation for this many simulated seconds, as fast as possible"
+      << " and without graphics, then print a summary. 0 runs in real time.  Min: " << ABSOLUTE_MIN_SIM_SECONDS
+      << "  Max: " << ABSOLUTE_MAX_SIM_SECONDS << "  Default: " << DEFAULT_SIM_SECONDS << std::endl;
+    std::cout << "-t : Match type, 'closest', 'simple' or 'batch'.  Default: "
       << DEFAULT_MATCH_TYPE << std::endl;
     std::cout << "-v : Max vehicles driving.  Min: 0  Max: "
       << ABSOLUTE_MAX_OBJECTS << "  Default: " << DEFAULT_MAX_OBJECTS << std::endl;
@@ -103,9 +135,13 @@ std::unordered_map<std::string, std::string> SimpleParser::SetDefaults() {
     std::unordered_map<std::string, std::string> settings;
 
     // Place all default values
+    settings.emplace("algorithm", DEFAULT_ALGORITHM);
+    settings.emplace("compile_map", "false");
+    settings.emplace("headless", "false");
     settings.emplace("map", DEFAULT_MAP);
     settings.emplace("match", DEFAULT_MATCH_TYPE);
     settings.emplace("passengers", DEFAULT_MAX_OBJECTS);
+    settings.emplace("sim_seconds", DEFAULT_SIM_SECONDS);
     settings.emplace("vehicles", DEFAULT_MAX_OBJECTS);
     settings.emplace("wait", DEFAULT_MIN_WAIT);
     settings.emplace("wait_range", DEFAULT_WAIT_RANGE);
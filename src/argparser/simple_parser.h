@@ -21,19 +21,24 @@ class SimpleParser {
   private:
     void MissingArgValue(std::string arg);
     std::string ParseMatchType(std::string input_match);
+    std::string ParseRouteAlgorithm(std::string input_algorithm);
     void ParseNumericInputs(std::string max_objects, std::string name, int min, int max);
     void PrintHelper();
     std::unordered_map<std::string, std::string> SetDefaults();
 
+    const std::string DEFAULT_ALGORITHM = "astar";
     const std::string DEFAULT_MAP = "downtown-kc";
     const std::string DEFAULT_MATCH_TYPE = "closest";
     const std::string DEFAULT_MAX_OBJECTS = "10"; // Vehicles & Passengers
     const std::string DEFAULT_MIN_WAIT = "3"; // Wait for next generation
     const std::string DEFAULT_WAIT_RANGE = "2"; // Range of wait time above min
-    const int ABSOLUTE_MAX_OBJECTS = 100; // Don't allow higher
+    const std::string DEFAULT_SIM_SECONDS = "0"; // Real-time simulation
+    const int ABSOLUTE_MAX_OBJECTS = 10000; // Don't allow higher
     const int ABSOLUTE_MIN_OBJECTS = 0; // Don't allow lower
     const int ABSOLUTE_MIN_WAIT = 1;
     const int ABSOLUTE_MIN_WAIT_RANGE = 0;
+    const int ABSOLUTE_MIN_SIM_SECONDS = 0;
+    const int ABSOLUTE_MAX_SIM_SECONDS = 7 * 24 * 60 * 60; // One week
 };
 
 }  // namespace rideshare
@@ -9,6 +9,7 @@
 #ifndef CONCURRENT_OBJECT_H_
 #define CONCURRENT_OBJECT_H_
 
+#include <chrono>
 #include <iostream>
 #include <mutex>
 #include <thread>
@@ -23,6 +24,8 @@ class ConcurrentObject {
 
     virtual void Simulate() {};
 
+    static constexpr std::chrono::milliseconds CYCLE_DURATION_{10}; // Time between movement steps
+
   protected:
     std::vector<std::thread> threads; // Holds all threads that have been launched within this object
     static std::mutex mtx_;           // Mutex shared by all concurrent objects for protecting cout
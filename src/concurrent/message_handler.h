@@ -9,28 +9,42 @@
 #ifndef MESSAGE_HANDLER_H_
 #define MESSAGE_HANDLER_H_
 
-#include <mutex>
 #include <vector>
 
+#include "message_queue.h"
 #include "simple_message.h"
+#include "wake_signal.h"
 
 namespace rideshare {
 
 class MessageHandler {
   public:
-    // Message receiving
-    virtual void Message(SimpleMessage simple_message) {};
+    // Constructor / Destructor
+    MessageHandler() { read_messages_.reserve(messages_.Capacity()); }
+
+    // Message receiving, safe to call from any thread without blocking the reader
+    void Message(SimpleMessage simple_message) {
+        messages_.Push(simple_message);
+        wake_signal_.Notify();
+    }
 
   protected:
     // Message reading
     virtual void ReadMessages() {};
+    // Move all received messages into read_messages_ (cleared first), for reading by the owning thread
+    void TakeMessages() {
+        read_messages_.clear();
+        messages_.Drain(read_messages_);
+    }
 
     // Store received messages
-    std::vector<SimpleMessage> messages_;
-    // Lock down messages_ while read/writing
-    std::mutex messages_mutex_;
+    MessageQueue<SimpleMessage> messages_;
+    // Messages taken for the current read, reused each cycle so reading doesn't allocate
+    std::vector<SimpleMessage> read_messages_;
+    // Wakes the reading thread when a message is received
+    WakeSignal wake_signal_;
 };
 
 }  // namespace rideshare
 
-#endif  // MESSAGE_HANDLER_H_
\ No newline at end of file
+#endif  // MESSAGE_HANDLER_H_
@@ -0,0 +1,146 @@
+/**
+ * @file message_queue.h
+ * @brief Lock-free ring queue for many producer threads and a single consumer thread, overflowing onto a locked list.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef MESSAGE_QUEUE_H_
+#define MESSAGE_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace rideshare {
+
+// Ring buffer where each slot carries a sequence number saying whether it is free to write
+//  (sequence == position) or ready to read (sequence == position + 1). Producers claim a
+//  position with a compare-and-swap, so they never take a lock the consumer could wait on.
+//  If the ring fills up, items go on a mutex-guarded overflow list until the consumer next drains,
+//  so pushing never waits on the consumer (which may be the same thread, in event mode).
+template <typename T>
+class MessageQueue {
+  public:
+    // Constructors / Destructors
+    // Capacity is rounded up to a power of two
+    explicit MessageQueue(size_t capacity = DEFAULT_CAPACITY);
+    MessageQueue(const MessageQueue&) = delete;
+    MessageQueue& operator=(const MessageQueue&) = delete;
+
+    // Getters / Setters
+    size_t Capacity() const { return mask_ + 1; }
+
+    // Primary functionality
+    // Add an item from any thread, returning false if the queue is full
+    bool TryPush(const T &item);
+    // Add an item from any thread, onto the overflow list if the ring is full (or already overflowed,
+    //  keeping each producer's items in order)
+    void Push(const T &item);
+    // Append all items currently in the queue onto `out` (consumer thread only), returning how many
+    size_t Drain(std::vector<T> &out);
+
+  private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 14;
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    // Items pushed while the ring was full, read after the ring's items
+    std::vector<T> overflow_;
+    std::mutex overflow_mtx_;
+    std::atomic<bool> overflowed_{false};
+    // Producer and consumer positions on separate cache lines so they don't contend
+    alignas(CACHE_LINE) std::atomic<size_t> push_position_{0};
+    alignas(CACHE_LINE) size_t pop_position_ = 0;
+};
+
+template <typename T>
+MessageQueue<T>::MessageQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    mask_ = size - 1;
+    slots_ = std::make_unique<Slot[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+bool MessageQueue<T>::TryPush(const T &item) {
+    size_t position = push_position_.load(std::memory_order_relaxed);
+    Slot *slot;
+    while (true) {
+        slot = &slots_[position & mask_];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        auto diff = (std::ptrdiff_t)sequence - (std::ptrdiff_t)position;
+        if (diff == 0) {
+            // Slot is free, try to claim this position
+            if (push_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Slot still holds an unread item from a lap ago, so the queue is full
+            return false;
+        } else {
+            // Another producer claimed this position first
+            position = push_position_.load(std::memory_order_relaxed);
+        }
+    }
+    slot->item = item;
+    // Publish the item to the consumer
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+void MessageQueue<T>::Push(const T &item) {
+    if (!overflowed_.load(std::memory_order_acquire) && TryPush(item)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lck(overflow_mtx_);
+    overflow_.push_back(item);
+    overflowed_.store(true, std::memory_order_release);
+}
+
+template <typename T>
+size_t MessageQueue<T>::Drain(std::vector<T> &out) {
+    // Stop after one lap so producers that keep pushing can't hold the consumer here
+    size_t count = 0;
+    while (count <= mask_) {
+        Slot &slot = slots_[pop_position_ & mask_];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != pop_position_ + 1) {
+            // Next slot not yet published, so nothing more to read
+            break;
+        }
+        out.push_back(slot.item);
+        // Free the slot for the producers' next lap
+        slot.sequence.store(pop_position_ + mask_ + 1, std::memory_order_release);
+        ++pop_position_;
+        ++count;
+    }
+    // Overflowed items are newer than any in the ring, as pushes skip the ring once it overflows
+    if (overflowed_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lck(overflow_mtx_);
+        out.insert(out.end(), overflow_.begin(), overflow_.end());
+        count += overflow_.size();
+        overflow_.clear();
+        overflowed_.store(false, std::memory_order_release);
+    }
+    return count;
+}
+
+}  // namespace rideshare
+
+#endif  // MESSAGE_QUEUE_H_
@@ -19,14 +19,14 @@ namespace rideshare {
 class ObjectHolder {
   public:
     // Constructor / Destructor
-    ObjectHolder(RouteModel *model, std::shared_ptr<RoutePlanner> route_planner,
+    ObjectHolder(const RouteModel *model, std::shared_ptr<RoutePlanner> route_planner,
                  int max_objects) :
       model_(model), route_planner_(route_planner), MAX_OBJECTS_(max_objects) {};
 
   protected:
     virtual void GenerateNew() {};
     const int MAX_OBJECTS_; // Set max number of objects to pause generation at
-    RouteModel *model_;
+    const RouteModel *model_; // Shared, read-only road graph
     double distance_per_cycle_; // max distance to move per cycle for smooth-looking movement
     int idCnt_ = 0; // Count object ids
     std::shared_ptr<RoutePlanner> route_planner_; // Route planner to use throughout the sim
@@ -8,19 +8,21 @@
 
 #include "passenger_queue.h"
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 #include <mutex>
 
 #include "ride_matcher.h"
 #include "simple_message.h"
+#include "wake_signal.h"
 #include "mapping/route_model.h"
 #include "map_object/passenger.h"
 #include "routing/route_planner.h"
 
 namespace rideshare {
 
-PassengerQueue::PassengerQueue(RouteModel *model,
+PassengerQueue::PassengerQueue(const RouteModel *model,
                                std::shared_ptr<RoutePlanner> route_planner,
                                int max_objects, int min_wait_time, int range_wait_time) :
                                ObjectHolder(model, route_planner, max_objects),
@@ -29,7 +31,7 @@ PassengerQueue::PassengerQueue(RouteModel *model,
     distance_per_cycle_ = std::abs(model_->MaxLat() - model->MinLat()) / 3000.0;
     // Start by creating half the max number of passengers
     // Note that the while loop avoids generating less if any invalid placements occur
-    while (new_passengers_.size() < MAX_OBJECTS_ / 2) {
+    while (static_cast<int>(new_passengers_.size()) < MAX_OBJECTS_ / 2) {
         GenerateNew();
     }
 }
@@ -53,6 +55,7 @@ void PassengerQueue::GenerateNew() {
     }
     // Set id to the passenger
     passenger->SetId(idCnt_++);
+    ++passengers_generated_;
     new_passengers_.emplace(passenger->Id(), passenger);
     // Output id and location of passenger requesting ride
     std::lock_guard<std::mutex> lck(mtx_);
@@ -66,63 +69,78 @@ void PassengerQueue::Simulate() {
 
 void PassengerQueue::WaitForRide() {
     // Set wait time between potentially generating new passengers
-    double cycleDuration = ((((float) rand() / RAND_MAX) * RANGE_WAIT_TIME_) + MIN_WAIT_TIME_) * 1000; // duration of a single simulation cycle in ms
-    std::chrono::time_point<std::chrono::system_clock> lastUpdate = std::chrono::system_clock::now();
+    auto cycleDuration = std::chrono::milliseconds(GenerationWait()); // duration of a single simulation cycle
+    auto lastUpdate = WakeSignal::Clock::now();
+    auto nextWalk = lastUpdate;
 
     while (true) {
-        // Sleep at every iteration to reduce CPU usage
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-
-        // Compute time difference to stop watch
-        long timeSinceLastUpdate = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - lastUpdate).count();
+        // Sleep until a message arrives, the next generation attempt is due,
+        //  or (only while passengers are walking) the next walking step
+        auto deadline = lastUpdate + cycleDuration;
+        if (!walking_passengers_.empty()) {
+            deadline = std::min(deadline, nextWalk);
+        }
+        wake_signal_.WaitUntil(deadline);
+        auto now = WakeSignal::Clock::now();
 
-        // Check if cycleDuration passed and if less than max passengers before creating a new one
-        if ((timeSinceLastUpdate >= cycleDuration) && (new_passengers_.size() < MAX_OBJECTS_)) {
-            GenerateNew();
+        // Check if cycleDuration passed before trying to create a new one
+        if (now - lastUpdate >= cycleDuration) {
+            GenerationStep();
             // Get a new random time to wait before checking to add a new passenger
-            cycleDuration = ((((float) rand() / RAND_MAX) * RANGE_WAIT_TIME_) + MIN_WAIT_TIME_) * 1000;
+            cycleDuration = std::chrono::milliseconds(GenerationWait());
             // Reset stop watch
-            lastUpdate = std::chrono::system_clock::now();
-        } else if ((timeSinceLastUpdate >= cycleDuration) && (new_passengers_.size() >= MAX_OBJECTS_)) {
-            // Note queue is full
-            std::unique_lock<std::mutex> lck(mtx_);
-            std::cout << "Queue full, no new passenger generated." << std::endl;
-            lck.unlock();
-            // Reset stop watch so wait a bit to see if queue frees up
-            lastUpdate = std::chrono::system_clock::now();
+            lastUpdate = now;
         }
 
         // Read and act on any messages
         ReadMessages();
 
-        // Walk toward vehicles for passengers who have an arrived ride
-        WalkPassengersToVehicles();
+        // Walk toward vehicles for passengers who have an arrived ride, one step per cycle
+        if (now >= nextWalk) {
+            WalkPassengersToVehicles();
+            nextWalk = now + CYCLE_DURATION_;
+        }
 
         // Request rides for passengers in queue, if not yet requested
-        for (auto passenger_pair : new_passengers_) {
-            if (passenger_pair.second->GetStatus() == Passenger::PassengerStatus::no_ride_requested) {
-                RequestRide(passenger_pair.second);
-            }
-        }
+        RequestRides();
     }
 }
 
-void PassengerQueue::Message(SimpleMessage simple_message) {
-    std::lock_guard<std::mutex> lck(messages_mutex_);
-    // Add the message for later reading
-    messages_.emplace_back(simple_message);
+long PassengerQueue::GenerationWait() {
+    return (long)(((((float) rand() / RAND_MAX) * RANGE_WAIT_TIME_) + MIN_WAIT_TIME_) * 1000);
+}
+
+void PassengerQueue::GenerationStep() {
+    // Only create a new passenger if less than max passengers
+    if (static_cast<int>(new_passengers_.size()) < MAX_OBJECTS_) {
+        GenerateNew();
+    } else {
+        // Note queue is full
+        std::lock_guard<std::mutex> lck(mtx_);
+        std::cout << "Queue full, no new passenger generated." << std::endl;
+    }
+}
+
+void PassengerQueue::Step() {
+    ReadMessages();
+    WalkPassengersToVehicles();
+    RequestRides();
+}
+
+void PassengerQueue::RequestRides() {
+    for (auto passenger_pair : new_passengers_) {
+        if (passenger_pair.second->GetStatus() == Passenger::PassengerStatus::no_ride_requested) {
+            RequestRide(passenger_pair.second);
+        }
+    }
 }
 
 void PassengerQueue::ReadMessages() {
-    // Lock and copy over the messages so can release the mutex faster
-    std::unique_lock<std::mutex> lck(messages_mutex_);
-    std::vector<SimpleMessage> copied_messages(messages_);
-    // Clear out the original messages and unlock
-    messages_.clear();
-    lck.unlock();
+    // Take all messages received since the last read
+    TakeMessages();
 
     // Take action based on each message code
-    for (auto message : copied_messages) {
+    for (const auto &message : read_messages_) {
         if (message.message_code == MsgCodes::ride_on_way) {
             RideOnWay(message.id);
         } else if (message.message_code == MsgCodes::ride_arrived) {
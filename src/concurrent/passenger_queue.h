@@ -40,19 +40,25 @@ class PassengerQueue : public ConcurrentObject, public ObjectHolder, public Mess
     };
 
     // Constructor / Destructor
-    PassengerQueue(RouteModel *model, std::shared_ptr<RoutePlanner> route_planner,
+    PassengerQueue(const RouteModel *model, std::shared_ptr<RoutePlanner> route_planner,
                    int max_objects, int min_wait_time, int range_wait_time);
     
     // Getters / Setters
     const std::unordered_map<int, std::shared_ptr<Passenger>>& NewPassengers() { return new_passengers_; }
     const std::unordered_map<int, std::shared_ptr<Passenger>>& WalkingPassengers() { return walking_passengers_; }
     void SetRideMatcher(std::shared_ptr<RideMatcher> ride_matcher) { ride_matcher_ = ride_matcher; }
+    int PassengersGenerated() const { return passengers_generated_; }
 
     // Concurrent simulation
     void Simulate();
 
-    // Message receiving
-    void Message(SimpleMessage simple_message);
+    // Discrete-event simulation (used in place of Simulate)
+    // Random time in ms to wait before the next attempt to generate a passenger
+    long GenerationWait();
+    // Generate a new passenger, unless the queue is full
+    void GenerationStep();
+    // Run a single cycle of reading messages, walking passengers and requesting rides
+    void Step();
 
   private:
     // Creation
@@ -64,6 +70,8 @@ class PassengerQueue : public ConcurrentObject, public ObjectHolder, public Mess
     // Ride match handling
     // Request a ride for a given passenger
     void RequestRide(std::shared_ptr<Passenger> passenger);
+    // Request rides for any passengers in queue that have not yet requested one
+    void RequestRides();
     // Notification that ride is on the way for a passenger
     void RideOnWay(int id);
     // Notification that ride has arrived for a passenger
@@ -88,6 +96,7 @@ class PassengerQueue : public ConcurrentObject, public ObjectHolder, public Mess
     std::unordered_map<int, std::shared_ptr<Passenger>> new_passengers_;
     std::unordered_map<int, std::shared_ptr<Passenger>> walking_passengers_;
     std::shared_ptr<RideMatcher> ride_matcher_;
+    int passengers_generated_ = 0;
 };
 
 }  // namespace rideshare
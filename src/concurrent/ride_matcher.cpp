@@ -8,22 +8,45 @@
 
 #include "ride_matcher.h"
 
-#include <map>
-#include <cmath>
+#include <algorithm>
+#include <limits>
 
 #include "passenger_queue.h"
 #include "simple_message.h"
 #include "vehicle_manager.h"
+#include "mapping/route_model.h"
 #include "map_object/passenger.h"
+#include "routing/route_planner.h"
 
 namespace rideshare {
 
+RideMatcher::RideMatcher(const RouteModel *model,
+                         std::shared_ptr<RoutePlanner> route_planner,
+                         std::shared_ptr<PassengerQueue> passenger_queue,
+                         std::shared_ptr<VehicleManager> vehicle_manager_,
+                         std::string match_type) :
+  model_(model), route_planner_(route_planner), passenger_queue_(passenger_queue), vehicle_manager_(vehicle_manager_),
+  MATCH_TYPE_(match_type) {}
+
 void RideMatcher::PassengerRequestsRide(int p_id) {
     passenger_ids_.emplace(p_id);
 }
 
 void RideMatcher::VehicleRequestsPassenger(int v_id) {
+    // The vehicle may have already left the map, in which case its ineligible message follows
+    auto fleet_lck = vehicle_manager_->Fleet().ReadLock();
+    int slot = vehicle_manager_->Fleet().Slot(v_id);
+    if (slot == VehicleFleet::NONE) {
+        return;
+    }
+    fleet_lck.unlock();
     vehicle_ids_.emplace(v_id);
+    // Index it if its road node already came in ahead of this request, otherwise once it does
+    auto request_node = unread_request_nodes_.find(v_id);
+    if (request_node != unread_request_nodes_.end()) {
+        IndexIdleVehicle(v_id, request_node->second);
+        unread_request_nodes_.erase(request_node);
+    }
 }
 
 void RideMatcher::VehicleCannotReachPassenger(int v_id) {
@@ -80,6 +103,8 @@ void RideMatcher::PassengerIsIneligible(int p_id) {
 void RideMatcher::VehicleIsIneligible(int v_id) {
     // Remove vehicle
     vehicle_ids_.erase(v_id);
+    UnindexIdleVehicle(v_id);
+    unread_request_nodes_.erase(v_id);
     // Check for any associated match
     if (vehicle_to_passenger_match_.count(v_id) == 1) {
         // Found a match, remove both sides
@@ -98,19 +123,30 @@ void RideMatcher::Simulate() {
 
 void RideMatcher::MatchRides() {
     while (true) {
-        // Sleep at every iteration to reduce CPU usage
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        // Sleep until a message arrives, checking again after a cycle while a match is still possible
+        if (passenger_ids_.size() > 0 && vehicle_ids_.size() > 0) {
+            wake_signal_.WaitUntil(WakeSignal::Clock::now() + CYCLE_DURATION_);
+        } else {
+            wake_signal_.Wait();
+        }
+
+        Step();
+    }
+}
 
-        // Read and act on any messages
-        ReadMessages();
+void RideMatcher::Step() {
+    // Read and act on any messages
+    ReadMessages();
+    UpdateIdleVehicleNodes();
 
-        // Match rides if more than one in each related queue
-        if (passenger_ids_.size() > 0 && vehicle_ids_.size() > 0) {
-            if (MATCH_TYPE_ == "closest") {
-                ClosestMatch();
-            } else {
-                SimpleMatch();
-            }
+    // Match rides if more than one in each related queue
+    if (passenger_ids_.size() > 0 && vehicle_ids_.size() > 0) {
+        if (MATCH_TYPE_ == "closest") {
+            ClosestMatch();
+        } else if (MATCH_TYPE_ == "batch") {
+            BatchMatch();
+        } else {
+            SimpleMatch();
         }
     }
 }
@@ -119,42 +155,36 @@ void RideMatcher::ClosestMatch() {
     // Get first passenger and their location
     int p_id = *passenger_ids_.begin();
     Coordinate p_loc = passenger_queue_->NewPassengers().at(p_id)->GetPosition();
-    // Set up needed vehicle data + structures
-    std::map<double, int> vehicle_distances; // ordered map of distance and v_id
-    Coordinate v_loc;
-    auto vehicle_iterator = vehicle_ids_.begin();
-
-    // Find a vehicle that is "close enough" or closest to first passenger
-    while (true) {
-        int v_id = *vehicle_iterator;
-        v_loc = vehicle_manager_->Vehicles().at(v_id)->GetPosition();
-        double distance = Distance(p_loc, v_loc);
-        bool valid = MatchIsValid(p_id, v_id);
-        if ((distance <= CLOSE_ENOUGH_) && valid) {
-            // Make the match
-            ProcessSingleMatch(p_id, v_id);
-            break; // end the loop
-        } else {
-            // Add to vehicle_distances if valid
-            if (valid) {
-                vehicle_distances.emplace(distance, v_id);
-            }
-            // Try to check any other vehicles
-            vehicle_iterator++;
-            if (vehicle_iterator != vehicle_ids_.end()) {
-                continue;
-            } else {
-                // Try to use the closest (valid) vehicle
-                if (!vehicle_distances.empty()) {
-                    // Make the match
-                    ProcessSingleMatch(p_id, (*vehicle_distances.begin()).second);
-                } else {
-                    // No currently possible matches
-                    NoPossibleMatch(p_id);
+    int match_id = VehicleFleet::NONE;
+    if (HasValidIdleVehicle(p_id)) {
+        // Search outward from the passenger only until reaching a road node with an idle vehicle not previously
+        //  found unable to reach them, which is the closest by road; vehicles that cannot reach them are never found
+        route_planner_->NearestRoadNode(model_->FindClosestNode(p_loc).Index(), [this, p_id, &match_id](int node_idx) {
+            auto idle = idle_vehicles_at_node_.find(node_idx);
+            if (idle != idle_vehicles_at_node_.end()) {
+                for (int v_id : idle->second) {
+                    if (MatchIsValid(p_id, v_id)) {
+                        match_id = v_id;
+                        return true;
+                    }
                 }
-                break; // end the loop
             }
+            return false;
+        });
+    }
+    if (match_id != VehicleFleet::NONE) {
+        auto fleet_lck = vehicle_manager_->Fleet().ReadLock();
+        if (vehicle_manager_->Fleet().Slot(match_id) == VehicleFleet::NONE) {
+            // Left the map, but its ineligible message isn't read yet, so try again next cycle
+            UnindexIdleVehicle(match_id);
+            return;
         }
+        fleet_lck.unlock();
+        // Make the match
+        ProcessSingleMatch(p_id, match_id);
+    } else {
+        // No currently possible matches
+        NoPossibleMatch(p_id);
     }
 }
 
@@ -184,6 +214,60 @@ void RideMatcher::SimpleMatch() {
     }
 }
 
+void RideMatcher::BatchMatch() {
+    // Copy out the ids and their closest road nodes, as processing matches erases them from the sets
+    batch_passenger_ids_.assign(passenger_ids_.begin(), passenger_ids_.end());
+    batch_passenger_nodes_.clear();
+    for (int p_id : batch_passenger_ids_) {
+        Coordinate p_loc = passenger_queue_->NewPassengers().at(p_id)->GetPosition();
+        batch_passenger_nodes_.emplace_back(model_->FindClosestNode(p_loc).Index());
+    }
+    batch_vehicle_ids_.clear();
+    batch_vehicle_nodes_.clear();
+    auto fleet_lck = vehicle_manager_->Fleet().ReadLock();
+    for (int v_id : vehicle_ids_) {
+        // Skip any vehicle not yet on a road node, or that left the map but whose ineligible message isn't read yet
+        auto indexed = idle_vehicle_nodes_.find(v_id);
+        if (indexed != idle_vehicle_nodes_.end() && vehicle_manager_->Fleet().Slot(v_id) != VehicleFleet::NONE) {
+            batch_vehicle_ids_.emplace_back(v_id);
+            batch_vehicle_nodes_.emplace_back(indexed->second);
+        }
+    }
+    fleet_lck.unlock();
+    int rows = batch_passenger_ids_.size();
+    int cols = batch_vehicle_ids_.size();
+    if (cols == 0) {
+        // Only vehicles about to be removed were left, so wait for the next cycle
+        return;
+    }
+    // Build the cost matrix of pickup road distances in one call, pricing out unreachable pairs
+    route_planner_->DistanceTable(batch_passenger_nodes_, batch_vehicle_nodes_, batch_distances_);
+    batch_costs_.resize(rows * cols);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            float distance = batch_distances_[(row * cols) + col];
+            bool valid = distance != RoutePlanner::UNREACHABLE && MatchIsValid(batch_passenger_ids_[row], batch_vehicle_ids_[col]);
+            batch_costs_[(row * cols) + col] = valid ? distance : INVALID_MATCH_COST_;
+        }
+    }
+
+    // Find the lowest total distance assignment, then make each of its matches
+    assignment_solver_.Solve(batch_costs_, rows, cols, batch_assignment_);
+    for (int row = 0; row < rows; ++row) {
+        int col = batch_assignment_[row];
+        if (col == AssignmentSolver::UNASSIGNED) {
+            // More passengers than vehicles, so wait for the next cycle
+            continue;
+        }
+        if (batch_costs_[(row * cols) + col] >= INVALID_MATCH_COST_) {
+            // Only an unreachable vehicle was left for this passenger
+            NoPossibleMatch(batch_passenger_ids_[row]);
+            continue;
+        }
+        ProcessSingleMatch(batch_passenger_ids_[row], batch_vehicle_ids_[col]);
+    }
+}
+
 void RideMatcher::ProcessSingleMatch(int p_id, int v_id) {
     // Make the match
     vehicle_to_passenger_match_.insert({v_id, p_id});
@@ -191,6 +275,8 @@ void RideMatcher::ProcessSingleMatch(int p_id, int v_id) {
     // Remove the ids from the sets
     passenger_ids_.erase(p_id);
     vehicle_ids_.erase(v_id);
+    UnindexIdleVehicle(v_id);
+    ++matches_made_;
     // Output the match to console
     std::unique_lock<std::mutex> lck(mtx_);
     std::cout << "Vehicle #" << v_id << " matched to Passenger #" << p_id << "." << std::endl;
@@ -226,27 +312,59 @@ void RideMatcher::ClearInvalids(int p_id) {
     }
 }
 
-double RideMatcher::Distance(Coordinate p_loc, Coordinate v_loc) {
-    // Calculate (euclidean) distance
-    return sqrt(pow(p_loc.x - v_loc.x, 2.0) + pow(p_loc.y - v_loc.y, 2.0));
+void RideMatcher::IndexIdleVehicle(int v_id, int node_idx) {
+    auto indexed = idle_vehicle_nodes_.find(v_id);
+    if (indexed != idle_vehicle_nodes_.end()) {
+        if (indexed->second == node_idx) {
+            return;
+        }
+        UnindexIdleVehicle(v_id);
+    }
+    idle_vehicle_nodes_.emplace(v_id, node_idx);
+    idle_vehicles_at_node_[node_idx].emplace_back(v_id);
 }
 
-void RideMatcher::Message(SimpleMessage simple_message) {
-    std::lock_guard<std::mutex> lck(messages_mutex_);
-    // Add the message for later reading
-    messages_.emplace_back(simple_message);
+void RideMatcher::UnindexIdleVehicle(int v_id) {
+    auto indexed = idle_vehicle_nodes_.find(v_id);
+    if (indexed == idle_vehicle_nodes_.end()) {
+        return;
+    }
+    // Swap-remove from the node's vehicles, leaving the emptied vector in place for the next vehicle there
+    std::vector<int> &at_node = idle_vehicles_at_node_.at(indexed->second);
+    *std::find(at_node.begin(), at_node.end(), v_id) = at_node.back();
+    at_node.pop_back();
+    idle_vehicle_nodes_.erase(indexed);
+}
+
+void RideMatcher::UpdateIdleVehicleNodes() {
+    // Only vehicles that drove onto a new road node since the last update need re-indexing
+    vehicle_manager_->TakeIdleRoadNodes(idle_road_nodes_);
+    for (const auto &[v_id, node_idx] : idle_road_nodes_) {
+        if (vehicle_ids_.count(v_id) == 1) {
+            IndexIdleVehicle(v_id, node_idx);
+        } else {
+            // Its request may not be read yet (otherwise it was just matched, and this is overwritten later)
+            unread_request_nodes_[v_id] = node_idx;
+        }
+    }
+}
+
+bool RideMatcher::HasValidIdleVehicle(int p_id) {
+    // Only the passenger's invalid matches need checking, as every other idle vehicle is valid
+    std::size_t invalid_idle = 0;
+    auto invalid = invalid_matches_.lower_bound({p_id, std::numeric_limits<int>::min()});
+    for (; invalid != invalid_matches_.end() && invalid->first == p_id; ++invalid) {
+        invalid_idle += idle_vehicle_nodes_.count(invalid->second);
+    }
+    return invalid_idle < idle_vehicle_nodes_.size();
 }
 
 void RideMatcher::ReadMessages() {
-    // Lock and copy over the messages so can release the mutex faster
-    std::unique_lock<std::mutex> lck(messages_mutex_);
-    std::vector<SimpleMessage> copied_messages(messages_);
-    // Clear out the original messages and unlock
-    messages_.clear();
-    lck.unlock();
+    // Take all messages received since the last read
+    TakeMessages();
 
     // Take action based on each message code
-    for (auto message : copied_messages) {
+    for (const auto &message : read_messages_) {
         switch (message.message_code) {
             case MsgCodes::passenger_requests_ride:
                 PassengerRequestsRide(message.id);
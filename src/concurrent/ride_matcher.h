@@ -14,13 +14,17 @@
 #include <set>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "concurrent_object.h"
 #include "message_handler.h"
 #include "passenger_queue.h"
 #include "simple_message.h"
 #include "vehicle_manager.h"
+#include "mapping/route_model.h"
 #include "map_object/passenger.h"
+#include "matching/assignment_solver.h"
+#include "routing/route_planner.h"
 
 namespace rideshare {
 
@@ -38,17 +42,21 @@ class RideMatcher : public ConcurrentObject, public MessageHandler {
     };
 
     // Constructor / Destructor
-    RideMatcher(std::shared_ptr<PassengerQueue> passenger_queue,
+    RideMatcher(const RouteModel *model,
+                std::shared_ptr<RoutePlanner> route_planner,
+                std::shared_ptr<PassengerQueue> passenger_queue,
                 std::shared_ptr<VehicleManager> vehicle_manager_,
-                double map_dim, std::string match_type) :
-      passenger_queue_(passenger_queue), vehicle_manager_(vehicle_manager_),
-      CLOSE_ENOUGH_(map_dim * MAP_FRACTION_), MATCH_TYPE_(match_type) {};
+                std::string match_type);
+
+    // Getters / Setters
+    int MatchesMade() const { return matches_made_; }
 
     // Concurrent simulation
     void Simulate();
 
-    // Message receiving
-    void Message(SimpleMessage simple_message);
+    // Discrete-event simulation
+    // Run a single cycle of reading messages and matching (used in place of Simulate)
+    void Step();
 
   private:
     // Pre-Matching
@@ -60,10 +68,12 @@ class RideMatcher : public ConcurrentObject, public MessageHandler {
     // Matching
     // Handles loop cycle of a single match at a time
     void MatchRides();
-    // Matches earliest passenger ID (close to FIFO) to a close or closest vehicle
+    // Matches earliest passenger ID (close to FIFO) to the closest valid vehicle by road
     void ClosestMatch();
     // Matches earliest passenger ID to earliest available vehicle ID
     void SimpleMatch();
+    // Matches all waiting passengers to idle vehicles at once, minimizing total pickup road distance
+    void BatchMatch();
     // Checks whether a given match was previously invalid due to being unreachable
     bool MatchIsValid(int p_id, int v_id);
     // Once match is determined, removes both sides from queue and notifies the related parties
@@ -91,10 +101,18 @@ class RideMatcher : public ConcurrentObject, public MessageHandler {
     // Utility
     // Clear out any previous invalid matches stored, as passenger either picked up or ineligible
     void ClearInvalids(int p_id);
-    // Calculate Euclidean distance between two coordinates (passenger and vehicle)
-    double Distance(Coordinate p_loc, Coordinate v_loc);
+    // Index an idle vehicle at the road node it is on, moving it from any node it was indexed at before
+    void IndexIdleVehicle(int v_id, int node_idx);
+    // Remove a vehicle from the idle vehicle index, if there
+    void UnindexIdleVehicle(int v_id);
+    // Idle vehicles keep driving, so re-index those the vehicle manager reports reached a new road node
+    void UpdateIdleVehicleNodes();
+    // Whether any idle vehicle was not previously found unable to reach the given passenger
+    bool HasValidIdleVehicle(int p_id);
 
     // Member variables
+    const RouteModel *model_;
+    std::shared_ptr<RoutePlanner> route_planner_;
     std::shared_ptr<PassengerQueue> passenger_queue_;
     std::shared_ptr<VehicleManager> vehicle_manager_;
     std::set<int> passenger_ids_;
@@ -102,9 +120,23 @@ class RideMatcher : public ConcurrentObject, public MessageHandler {
     std::unordered_map<int, int> vehicle_to_passenger_match_;
     std::unordered_map<int, int> passenger_to_vehicle_match_;
     std::set<std::pair<int, int>> invalid_matches_; // p_id, v_id
-    const double MAP_FRACTION_ = 0.15; // Fraction of map to be "close enough"
-    const double CLOSE_ENOUGH_; // Avg. map dimension * MAP_FRACTION_
-    const std::string MATCH_TYPE_; // "closest" or "simple" matching
+    const std::string MATCH_TYPE_; // "closest", "simple" or "batch" matching
+    // Idle vehicles by the road node they are on, for closest matching to search the roads out to
+    std::unordered_map<int, std::vector<int>> idle_vehicles_at_node_; // road node -> idle vehicle ids
+    std::unordered_map<int, int> idle_vehicle_nodes_; // idle vehicle id -> road node it is indexed at
+    std::unordered_map<int, int> unread_request_nodes_; // vehicle id -> road node, for requests not yet read
+    std::unordered_map<int, int> idle_road_nodes_; // vehicle id -> road node changes taken from the vehicle manager
+    // Batch matching work space, kept between cycles to avoid re-allocating
+    AssignmentSolver assignment_solver_;
+    std::vector<int> batch_passenger_ids_;
+    std::vector<int> batch_vehicle_ids_;
+    std::vector<int> batch_passenger_nodes_; // closest road node to each passenger
+    std::vector<int> batch_vehicle_nodes_; // closest road node to each vehicle
+    std::vector<float> batch_distances_; // passengers x vehicles road distances, row-major
+    std::vector<double> batch_costs_; // passengers x vehicles, row-major
+    std::vector<int> batch_assignment_; // vehicle column for each passenger row
+    const double INVALID_MATCH_COST_ = 1e9; // Far above any real total distance
+    int matches_made_ = 0;
 };
 
 }  // namespace rideshare
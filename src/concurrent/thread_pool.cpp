@@ -0,0 +1,121 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Implementation of a work-stealing pool for running loops in parallel.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace rideshare {
+
+ThreadPool::ThreadPool(int worker_count) {
+    for (int i = 0; i <= worker_count; ++i) {
+        queues_.emplace_back(std::make_unique<WorkQueue>());
+    }
+    for (int i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    std::unique_lock<std::mutex> lck(mtx_);
+    stop_ = true;
+    lck.unlock();
+    start_cv_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+int ThreadPool::DefaultWorkerCount() {
+    return std::max(0, (int)std::thread::hardware_concurrency() - 1);
+}
+
+void ThreadPool::ParallelFor(int count, const std::function<void(int)> &body) {
+    int threads = queues_.size();
+    if (threads == 1 || count <= 1) {
+        // Nothing to split the work with
+        for (int i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    // Split the indices into ranges, dealt out across the queues
+    int range_count = std::min(count, threads * RANGES_PER_THREAD_);
+    body_ = &body;
+    ranges_left_.store(range_count);
+    for (int r = 0; r < range_count; ++r) {
+        Range range = { .begin = (int)((long)count * r / range_count), .end = (int)((long)count * (r + 1) / range_count) };
+        WorkQueue &queue = *queues_[r % threads];
+        std::lock_guard<std::mutex> lck(queue.mtx);
+        queue.ranges.push_back(range);
+    }
+
+    // Wake the workers, then help out until the queues are empty
+    std::unique_lock<std::mutex> lck(mtx_);
+    ++generation_;
+    lck.unlock();
+    start_cv_.notify_all();
+    while (RunRange(threads - 1)) {}
+
+    // Wait on any ranges other threads are still running
+    lck.lock();
+    done_cv_.wait(lck, [this] { return ranges_left_.load() == 0; });
+    body_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop(int queue) {
+    unsigned long seen_generation = 0;
+    while (true) {
+        std::unique_lock<std::mutex> lck(mtx_);
+        start_cv_.wait(lck, [this, seen_generation] { return stop_ || generation_ != seen_generation; });
+        if (stop_) {
+            return;
+        }
+        seen_generation = generation_;
+        lck.unlock();
+        while (RunRange(queue)) {}
+    }
+}
+
+bool ThreadPool::RunRange(int queue) {
+    Range range;
+    bool found = false;
+    // Check this thread's own queue first, then steal from the others in turn
+    int threads = queues_.size();
+    for (int offset = 0; offset < threads && !found; ++offset) {
+        WorkQueue &from = *queues_[(queue + offset) % threads];
+        std::lock_guard<std::mutex> lck(from.mtx);
+        if (from.ranges.empty()) {
+            continue;
+        }
+        if (offset == 0) {
+            range = from.ranges.front();
+            from.ranges.pop_front();
+        } else {
+            range = from.ranges.back();
+            from.ranges.pop_back();
+        }
+        found = true;
+    }
+    if (!found) {
+        return false;
+    }
+
+    for (int i = range.begin; i < range.end; ++i) {
+        (*body_)(i);
+    }
+    // Let the caller know once the last range is done
+    if (ranges_left_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lck(mtx_);
+        done_cv_.notify_all();
+    }
+    return true;
+}
+
+}  // namespace rideshare
@@ -0,0 +1,76 @@
+/**
+ * @file thread_pool.h
+ * @brief Fixed pool of worker threads that split loops between them, stealing work when idle.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rideshare {
+
+class ThreadPool {
+  public:
+    // Constructors / Destructors
+    // Start the given number of workers; the thread calling ParallelFor also does work
+    explicit ThreadPool(int worker_count);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Getters / Setters
+    int WorkerCount() const { return workers_.size(); }
+    // Workers to use so every hardware thread is busy, counting the calling thread
+    static int DefaultWorkerCount();
+
+    // Primary functionality
+    // Call body(i) for every i in [0, count), spread across the pool, returning once all calls are done.
+    //  Calls must be safe to run at the same time. Only one thread may call this at a time.
+    void ParallelFor(int count, const std::function<void(int)> &body);
+
+  private:
+    // Consecutive indices run together, so small bodies aren't swamped by scheduling costs
+    struct Range {
+        int begin;
+        int end;
+    };
+
+    // Each thread takes ranges from the front of its own queue, and steals from the back of others'
+    struct WorkQueue {
+        std::mutex mtx;
+        std::deque<Range> ranges;
+    };
+
+    // Sleep until there is a loop to work on, then run ranges until none are left
+    void WorkerLoop(int queue);
+    // Run one range from the given queue, or stolen from another, returning false if none were left
+    bool RunRange(int queue);
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<WorkQueue>> queues_; // one per worker, plus the last for the caller
+    const std::function<void(int)> *body_ = nullptr; // loop body currently being run
+    std::atomic<int> ranges_left_{0};
+    // Guards the loop generation and stopping, and signals workers to start / the caller that all is done
+    std::mutex mtx_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    unsigned long generation_ = 0;
+    bool stop_ = false;
+
+    const int RANGES_PER_THREAD_ = 4; // Extra ranges give idle threads something to steal
+};
+
+}  // namespace rideshare
+
+#endif  // THREAD_POOL_H_
@@ -8,20 +8,27 @@
 
 #include "vehicle_manager.h"
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
 
 #include "ride_matcher.h"
 #include "mapping/coordinate.h"
 #include "mapping/route_model.h"
 #include "map_object/passenger.h"
-#include "map_object/vehicle.h"
+#include "map_object/vehicle_fleet.h"
 #include "routing/route_planner.h"
 
 namespace rideshare {
 
-VehicleManager::VehicleManager(RouteModel *model,
+VehicleManager::VehicleManager(const RouteModel *model,
                                std::shared_ptr<RoutePlanner> route_planner,
-                               int max_objects) : ObjectHolder(model, route_planner, max_objects) {
+                               int max_objects) : ObjectHolder(model, route_planner, max_objects),
+                               fleet_(model, std::abs(model->MaxLat() - model->MinLat()) / 1000.0),
+                               thread_pool_(ThreadPool::DefaultWorkerCount()) {
     // Set distance per cycle based on model's latitudes
     distance_per_cycle_ = std::abs(model_->MaxLat() - model->MinLat()) / 1000.0;
     // Generate max number of vehicles at the start
@@ -38,27 +45,23 @@ void VehicleManager::GenerateNew() {
     // Find the nearest road node to start and destination positions
     auto nearest_start = model_->FindClosestNode(start);
     auto nearest_dest = model_->FindClosestNode(destination);
-    // Set road position, destination and id of vehicle
-    std::shared_ptr<Vehicle> vehicle = std::make_shared<Vehicle>(distance_per_cycle_);
-    vehicle->SetPosition((Coordinate){.x = nearest_start.x, .y = nearest_start.y});
-    vehicle->SetDestination((Coordinate){.x = nearest_dest.x, .y = nearest_dest.y});
-    vehicle->SetId(idCnt_++);
-    vehicles_.emplace(vehicle->Id(), vehicle);
+    // Add the vehicle with its road position, destination and id
+    fleet_.Add(idCnt_++, (Coordinate){.x = nearest_start.x, .y = nearest_start.y}, (Coordinate){.x = nearest_dest.x, .y = nearest_dest.y});
     // Output id and location of vehicle looking to give rides
     std::lock_guard<std::mutex> lck(mtx_);
     std::cout << "Vehicle #" << idCnt_ - 1 << " now driving from: " << nearest_start.y << ", " << nearest_start.x << "." << std::endl;
 }
 
-void VehicleManager::ResetVehicleDestination(std::shared_ptr<Vehicle> vehicle, bool random) {
+void VehicleManager::ResetVehicleDestination(int slot, bool random) {
     Coordinate destination;
     // Depending on `random`, either get a new random position or set current destination onto nearest node
     if (random) {
         destination = model_->GetRandomMapPosition();
     } else {
-        destination = vehicle->GetDestination();
+        destination = fleet_.Destination(slot);
     }
     auto nearest_dest = model_->FindClosestNode(destination);
-    vehicle->SetDestination((Coordinate){.x = nearest_dest.x, .y = nearest_dest.y});
+    fleet_.SetDestination(slot, (Coordinate){.x = nearest_dest.x, .y = nearest_dest.y});
 }
 
 void VehicleManager::Simulate() {
@@ -67,97 +70,166 @@ void VehicleManager::Simulate() {
 }
 
 void VehicleManager::Drive() {
+    auto next_drive = WakeSignal::Clock::now();
     while (true) {
-        // Sleep at every iteration to reduce CPU usage
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-
-        // Pick up any available passengers first
-        PickUpPassengers();
-        // Assign any new matches
-        NewPassengerAssignments();
-
-        // Drive the vehicles
-        for (auto & [id, vehicle] : vehicles_) {
-            // Get a route if none yet given
-            if (vehicle->Path().empty()) {
-                route_planner_->AStarSearch(vehicle);
-                if (vehicle->Path().empty()) {
-                    if (vehicle->State() == VehicleState::no_passenger_requested || vehicle->State() == VehicleState::no_passenger_queued) {
-                        SimpleVehicleFailure(vehicle);
-                        continue;
-                    }
-                }
-            }
+        // Sleep until the next drive cycle, or until a new assignment or pickup comes in
+        wake_signal_.WaitUntil(next_drive);
 
-            // Request a passenger if don't have one yet
-            if (vehicle->State() == VehicleState::no_passenger_requested) {
-                RequestPassenger(vehicle);
-            }
+        // Handle pickups and assignments right away
+        HandlePassengers();
 
-            // Drive to destination or wait, depending on state
-            if (vehicle->State() == VehicleState::waiting) {
-                continue;
-            } else {
-                // Drive to current destination
-                vehicle->IncrementalMove();
-            }
+        // Only move the vehicles once per cycle, even if woken early
+        auto now = WakeSignal::Clock::now();
+        if (now < next_drive) {
+            continue;
+        }
+        next_drive = now + CYCLE_DURATION_;
+        DriveVehicles();
+    }
+}
 
-            // Check if at destination
-            if (vehicle->GetPosition() == vehicle->GetDestination()) {
-                if (vehicle->State() == VehicleState::no_passenger_queued) {
-                    // Find a new random destination
-                    ResetVehicleDestination(vehicle, true);
-                } else if (vehicle->State() == VehicleState::passenger_queued) {
-                    // Notify of arrival
-                    ArrivedAtPassenger(vehicle);
-                } else if (vehicle->State() == VehicleState::driving_passenger) {
-                    // Drop-off passenger
-                    DropOffPassenger(vehicle);
+void VehicleManager::Step() {
+    HandlePassengers();
+    DriveVehicles();
+}
+
+void VehicleManager::HandlePassengers() {
+    // Pick up any available passengers first
+    PickUpPassengers();
+    // Assign any new matches
+    NewPassengerAssignments();
+}
+
+void VehicleManager::DriveVehicles() {
+    int count = fleet_.Size();
+    route_failed_.assign(count, false);
+    reached_node_.assign(count, false);
+
+    // Parallel phases, each vehicle only touching its own slot
+    // Plan any missing routes (most cycles have none, so only the vehicles needing one are handed out)
+    to_plan_.clear();
+    for (int slot = 0; slot < count; ++slot) {
+        if (fleet_.PathLength(slot) == 0) {
+            to_plan_.emplace_back(slot);
+        }
+    }
+    if (!to_plan_.empty()) {
+        if (planned_paths_.size() < to_plan_.size()) {
+            planned_paths_.resize(to_plan_.size());
+        }
+        thread_pool_.ParallelFor(to_plan_.size(), [this](int i) {
+            int slot = to_plan_[i];
+            route_planner_->AStarSearch(fleet_.Position(slot), fleet_.Destination(slot), planned_paths_[i]);
+            if (planned_paths_[i].empty()) {
+                if (fleet_.State(slot) == VehicleState::no_passenger_requested || fleet_.State(slot) == VehicleState::no_passenger_queued) {
+                    route_failed_[slot] = true;
                 }
             }
+        });
+        // The fleet's paths share one buffer, so copy the new routes in one at a time
+        for (std::size_t i = 0; i < to_plan_.size(); ++i) {
+            fleet_.SetPath(to_plan_[i], planned_paths_[i]);
+        }
+    }
+    // Drive to current destination, unless waiting; positions are read by other threads, so keep them out meanwhile
+    std::unique_lock<std::shared_mutex> fleet_lck = fleet_.WriteLock();
+    thread_pool_.ParallelFor(count, [this](int slot) {
+        if (!route_failed_[slot] && fleet_.State(slot) != VehicleState::waiting) {
+            reached_node_[slot] = fleet_.IncrementalMove(slot);
+        }
+    });
+    fleet_lck.unlock();
+
+    // Serial phase: apply state changes and send messages, in slot order
+    for (int slot = 0; slot < count; ++slot) {
+        if (route_failed_[slot]) {
+            SimpleVehicleFailure(slot);
+            continue;
         }
 
-        // Remove any vehicles that had issues on the map
-        if (to_remove_.size() > 0) {
-            for (int id : to_remove_) {
-                // Notify ride matcher (doesn't matter for no request state or driving, but does for others)
-                ride_matcher_->Message({ .message_code=RideMatcher::vehicle_is_ineligible, .id=id });
-                // Erase the vehicle
-                vehicles_.erase(id);
+        // Let the ride matcher re-index a vehicle waiting for a match once it reaches a new road node
+        if (reached_node_[slot] && fleet_.State(slot) == VehicleState::no_passenger_queued) {
+            cycle_idle_road_nodes_.emplace_back(fleet_.Id(slot), fleet_.RoadNode(slot));
+        }
+
+        // Request a passenger if don't have one yet
+        if (fleet_.State(slot) == VehicleState::no_passenger_requested) {
+            RequestPassenger(slot);
+        }
+
+        // Nothing more to do when waiting
+        if (fleet_.State(slot) == VehicleState::waiting) {
+            continue;
+        }
+
+        // Check if at destination
+        if (fleet_.Position(slot) == fleet_.Destination(slot)) {
+            if (fleet_.State(slot) == VehicleState::no_passenger_queued) {
+                // Find a new random destination
+                ResetVehicleDestination(slot, true);
+            } else if (fleet_.State(slot) == VehicleState::passenger_queued) {
+                // Notify of arrival
+                ArrivedAtPassenger(slot);
+            } else if (fleet_.State(slot) == VehicleState::driving_passenger) {
+                // Drop-off passenger
+                DropOffPassenger(slot);
             }
-            // Clear the to_remove_ vector for next time
-            to_remove_.clear();
         }
+    }
+
+    // Hand over the cycle's idle road node changes all at once, only keeping the latest per vehicle
+    if (!cycle_idle_road_nodes_.empty()) {
+        std::lock_guard<std::mutex> lck(idle_road_nodes_mutex);
+        for (const auto &[id, node_idx] : cycle_idle_road_nodes_) {
+            idle_road_nodes_[id] = node_idx;
+        }
+        cycle_idle_road_nodes_.clear();
+    }
 
-        // Make sure to keep max vehicles on the road
-        if (vehicles_.size() < MAX_OBJECTS_) {
-            GenerateNew();
+    // Remove any vehicles that had issues on the map
+    if (to_remove_.size() > 0) {
+        for (int id : to_remove_) {
+            // Notify ride matcher (doesn't matter for no request state or driving, but does for others)
+            ride_matcher_->Message({ .message_code=RideMatcher::vehicle_is_ineligible, .id=id });
+            // Erase the vehicle (moves another vehicle into its slot, so only done once all slots are handled)
+            fleet_.Remove(id);
         }
+        // Clear the to_remove_ vector for next time
+        to_remove_.clear();
+    }
+
+    // Make sure to keep max vehicles on the road
+    if (fleet_.Size() < MAX_OBJECTS_) {
+        GenerateNew();
     }
 }
 
-void VehicleManager::SimpleVehicleFailure(std::shared_ptr<Vehicle> vehicle) {
+void VehicleManager::SimpleVehicleFailure(int slot) {
     // Note: This should only be called when vehicle has not yet picked up a passenger
     // Check if enough failures to delete
-    bool remove = vehicle->MovementFailure();
+    bool remove = fleet_.MovementFailure(slot);
     if (remove) {
         // Plan to erase the vehicle
-        to_remove_.emplace_back(vehicle->Id());
+        to_remove_.emplace_back(fleet_.Id(slot));
         // Note to console
         std::lock_guard<std::mutex> lck(mtx_);
-        std::cout << "Vehicle #" << vehicle->Id() <<" is stuck, leaving map." << std::endl;
+        std::cout << "Vehicle #" << fleet_.Id(slot) <<" is stuck, leaving map." << std::endl;
     } else {
         // Try a new route
-        ResetVehicleDestination(vehicle, true);
+        ResetVehicleDestination(slot, true);
     }
 }
 
-void VehicleManager::RequestPassenger(std::shared_ptr<Vehicle> vehicle) {
+void VehicleManager::RequestPassenger(int slot) {
     // Update state first (make sure no async issues)
-    vehicle->SetState(VehicleState::no_passenger_queued);
+    fleet_.SetState(slot, VehicleState::no_passenger_queued);
+    // The ride matcher indexes idle vehicles by road node, so pass along where this one is (once it reached one)
+    if (fleet_.RoadNode(slot) != VehicleFleet::NONE) {
+        cycle_idle_road_nodes_.emplace_back(fleet_.Id(slot), fleet_.RoadNode(slot));
+    }
     // Request the passenger from the ride matcher
     if (ride_matcher_ != nullptr) {
-        ride_matcher_->Message({ .message_code=RideMatcher::vehicle_requests_passenger, .id=vehicle->Id() });
+        ride_matcher_->Message({ .message_code=RideMatcher::vehicle_requests_passenger, .id=fleet_.Id(slot) });
     }
 }
 
@@ -165,6 +237,13 @@ void VehicleManager::AssignPassenger(int id, Coordinate position) {
     std::lock_guard<std::mutex> lck(new_assignment_locations_mutex);
     // Add the newly assigned passenger pickup position for later use
     new_assignment_locations.emplace(id, position);
+    wake_signal_.Notify();
+}
+
+void VehicleManager::TakeIdleRoadNodes(std::unordered_map<int, int> &idle_road_nodes) {
+    idle_road_nodes.clear();
+    std::lock_guard<std::mutex> lck(idle_road_nodes_mutex);
+    idle_road_nodes.swap(idle_road_nodes_);
 }
 
 void VehicleManager::NewPassengerAssignments() {
@@ -177,56 +256,59 @@ void VehicleManager::NewPassengerAssignments() {
 
     // Loop through an assign passenger pick up locations to related vehicles
     for (auto [id, position] : copied_assignments) {
-        auto vehicle = vehicles_.at(id);
-        // Store current position
-        Coordinate curr_pos = vehicle->GetPosition();
+        int slot = fleet_.Slot(id);
+        if (slot == VehicleFleet::NONE) {
+            // Left the map after being matched; the ride matcher fails the passenger on its ineligible message
+            continue;
+        }
         // Set position for use with route to passenger as the next node on the path
         // Avoids potential issue if current position is closest to an unreachable node
-        if (vehicle->Path().empty()) {
+        if (fleet_.PathLength(slot) == 0) {
             // Empty path likely a result of failure, so don't progress with assignment
-            AssignmentFailure(vehicle);
+            AssignmentFailure(slot);
             return;
         }
-        Model::Node next_node = vehicle->Path().at(vehicle->PathIndex());
-        vehicle->SetPosition({ .x = next_node.x, .y = next_node.y });
+        // Past the end of the path means the vehicle is sitting on its last node
+        int next_idx = std::min(fleet_.PathIndex(slot), fleet_.PathLength(slot) - 1);
+        const RouteModel::Node &next_node = model_->SNodes()[fleet_.PathNode(slot, next_idx)];
         // Set new vehicle destination and update its state
-        vehicle->SetDestination(position);
-        ResetVehicleDestination(vehicle, false); // Aligns to route node
-        // Get the path to the passenger
-        route_planner_->AStarSearch(vehicle);
-        // Set position back to original to keep smooth route
-        vehicle->SetPosition(curr_pos);
+        fleet_.SetDestination(slot, position);
+        ResetVehicleDestination(slot, false); // Aligns to route node
+        // Get the path to the passenger, starting from the next node
+        route_planner_->AStarSearch({ .x = next_node.x, .y = next_node.y }, fleet_.Destination(slot), assignment_path_);
         // Make sure path is not empty (unreachable), then update the state
-        if (vehicle->Path().empty()) {
-            AssignmentFailure(vehicle);
+        if (assignment_path_.empty()) {
+            AssignmentFailure(slot);
         } else {
+            fleet_.SetPath(slot, assignment_path_);
             // Update state when done processing
-            vehicle->SetState(VehicleState::passenger_queued);
+            fleet_.SetState(slot, VehicleState::passenger_queued);
         }
     }
 }
 
-void VehicleManager::AssignmentFailure(std::shared_ptr<Vehicle> vehicle) {
+void VehicleManager::AssignmentFailure(int slot) {
     // Notify ride matcher of failure
-    ride_matcher_->Message({ .message_code=RideMatcher::vehicle_cannot_reach_passenger, .id=vehicle->Id() });
+    ride_matcher_->Message({ .message_code=RideMatcher::vehicle_cannot_reach_passenger, .id=fleet_.Id(slot) });
     // Set state to nothing requested so it will make a new request
-    vehicle->SetState(VehicleState::no_passenger_requested);
+    fleet_.SetState(slot, VehicleState::no_passenger_requested);
     // Add to vehicle failures
     // Note that ride matcher notified in `Drive` if deletion occurs
-    SimpleVehicleFailure(vehicle);
+    SimpleVehicleFailure(slot);
 }
 
-void VehicleManager::ArrivedAtPassenger(std::shared_ptr<Vehicle> vehicle) {
+void VehicleManager::ArrivedAtPassenger(int slot) {
     // Transition to waiting
-    vehicle->SetState(VehicleState::waiting);
+    fleet_.SetState(slot, VehicleState::waiting);
     // Notify ride matcher
-    ride_matcher_->Message({ .message_code=RideMatcher::vehicle_has_arrived, .id=vehicle->Id() });
+    ride_matcher_->Message({ .message_code=RideMatcher::vehicle_has_arrived, .id=fleet_.Id(slot) });
 }
 
 void VehicleManager::PassengerIntoVehicle(int id, std::shared_ptr<Passenger> passenger) {
     std::lock_guard<std::mutex> pickups_lock(passenger_pickups_mutex);
     // Add to passenger pickups map
     passenger_pickups_.emplace(id, passenger);
+    wake_signal_.Notify();
 }
 
 void VehicleManager::PickUpPassengers() {
@@ -239,30 +321,40 @@ void VehicleManager::PickUpPassengers() {
 
     // Loop through all ready passenger pickups
     for (auto [id, passenger] : copied_pickups) {
-        auto vehicle = vehicles_.at(id);
+        int slot = fleet_.Slot(id);
         // Output notice to console
         std::unique_lock<std::mutex> lck(mtx_);
-        std::cout << "Vehicle #" << vehicle->Id() << " picked up Passenger #" << passenger->Id() << "." << std::endl;
+        std::cout << "Vehicle #" << id << " picked up Passenger #" << passenger->Id() << "." << std::endl;
         lck.unlock();
         // Set passenger into vehicle
-        vehicle->SetPassenger(passenger); // Vehicle handles setting new destination with passenger
-        ResetVehicleDestination(vehicle, false); // Aligns to route node
+        fleet_.SetPassenger(slot, passenger); // Fleet handles setting new destination with passenger
+        ResetVehicleDestination(slot, false); // Aligns to route node
+        // Take over the route found when the passenger was generated, saving a new search,
+        //  as long as the vehicle is at the road node the route starts from
+        const std::vector<int> &trip = passenger->Path();
+        if (!trip.empty()) {
+            const RouteModel::Node &trip_start = model_->SNodes()[trip.front()];
+            if (fleet_.Position(slot) == (Coordinate){.x = trip_start.x, .y = trip_start.y}) {
+                fleet_.SetPath(slot, trip);
+            }
+        }
         // Update state when done processing
-        vehicle->SetState(VehicleState::driving_passenger);
+        fleet_.SetState(slot, VehicleState::driving_passenger);
     }
 }
 
-void VehicleManager::DropOffPassenger(std::shared_ptr<Vehicle> vehicle) {
+void VehicleManager::DropOffPassenger(int slot) {
     // Output notice to console
     std::unique_lock<std::mutex> lck(mtx_);
-    std::cout << "Vehicle #" << vehicle->Id() << " dropped off Passenger #" << vehicle->GetPassenger()->Id() << "." << std::endl;
+    std::cout << "Vehicle #" << fleet_.Id(slot) << " dropped off Passenger #" << fleet_.GetPassenger(slot)->Id() << "." << std::endl;
     lck.unlock();
     // Drop off the passenger
-    vehicle->DropOffPassenger();
+    fleet_.DropOffPassenger(slot);
+    ++passengers_dropped_off_;
     // Find a new random destination
-    ResetVehicleDestination(vehicle, true);
+    ResetVehicleDestination(slot, true);
     // Transition back to no passenger requested state
-    vehicle->SetState(VehicleState::no_passenger_requested);
+    fleet_.SetState(slot, VehicleState::no_passenger_requested);
 }
 
 }  // namespace rideshare
@@ -12,14 +12,17 @@
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "concurrent_object.h"
 #include "object_holder.h"
+#include "thread_pool.h"
+#include "wake_signal.h"
 #include "mapping/coordinate.h"
 #include "mapping/route_model.h"
 #include "map_object/passenger.h"
-#include "map_object/vehicle.h"
+#include "map_object/vehicle_fleet.h"
 #include "routing/route_planner.h"
 
 // Avoid circular includes
@@ -32,20 +35,28 @@ namespace rideshare {
 class VehicleManager : public ConcurrentObject, public ObjectHolder {
   public:
     // Constructor / Destructor
-    VehicleManager(RouteModel *model, std::shared_ptr<RoutePlanner> route_planner, int max_objects);
+    VehicleManager(const RouteModel *model, std::shared_ptr<RoutePlanner> route_planner, int max_objects);
     
     // Getters / Setters
-    const std::unordered_map<int, std::shared_ptr<Vehicle>>& Vehicles() { return vehicles_; }
+    const VehicleFleet& Fleet() { return fleet_; }
     void SetRideMatcher(std::shared_ptr<RideMatcher> ride_matcher) { ride_matcher_ = ride_matcher; }
+    int PassengersDroppedOff() const { return passengers_dropped_off_; }
 
     // Concurrent simulation
     void Simulate();
 
+    // Discrete-event simulation
+    // Run a single cycle of pickups, assignments and driving (used in place of Simulate)
+    void Step();
+
     // Passenger-related handling
     // Receive any new passenger assignments
     void AssignPassenger(int id, Coordinate position);
     // Receive any passengers ready to be picked up by specified vehicle its post-arrival
     void PassengerIntoVehicle(int id, std::shared_ptr<Passenger> passenger);
+    // Swap out the latest road node of each vehicle waiting for a match that requested a passenger
+    //  or drove onto a new road node since the last call, by vehicle id
+    void TakeIdleRoadNodes(std::unordered_map<int, int> &idle_road_nodes);
 
   private:
     // Creation
@@ -54,33 +65,49 @@ class VehicleManager : public ConcurrentObject, public ObjectHolder {
     // Movement
     // Handle loop cycle of movements and actions based on assignments / arrival at passengers
     void Drive();
+    // Pick up any passengers ready for pickup and route vehicles to newly assigned passengers
+    void HandlePassengers();
+    // Move every vehicle one cycle along its path (in parallel), apply any resulting state changes,
+    //  then remove stuck vehicles and generate new ones
+    void DriveVehicles();
     // Either gets a random map position, or uses the given destination, and aligns either to closest map node
-    void ResetVehicleDestination(std::shared_ptr<Vehicle> vehicle, bool random);
+    void ResetVehicleDestination(int slot, bool random);
     // Vehicle has encountered some type of issue reaching a given destination, without a passenger within
-    void SimpleVehicleFailure(std::shared_ptr<Vehicle> vehicle);
+    void SimpleVehicleFailure(int slot);
 
     // Passenger-related handling
     // Request a passenger to pick up from the ride matcher
-    void RequestPassenger(std::shared_ptr<Vehicle> vehicle);
+    void RequestPassenger(int slot);
     // Notify specified vehicle of passenger assignment, given the passenger's current position
     void NewPassengerAssignments();
     // Handle aspects of being unable to reach a matched passenger (notify ride matcher, re-request, add a simple failure)
-    void AssignmentFailure(std::shared_ptr<Vehicle> vehicle);
+    void AssignmentFailure(int slot);
     // Notify ride matcher that vehicle arrived at node nearest to passenger position
-    void ArrivedAtPassenger(std::shared_ptr<Vehicle> vehicle);
+    void ArrivedAtPassenger(int slot);
     // Pick up any passengers now ready to be picked up post-arrival
     void PickUpPassengers();
     // Drop off the passenger once nearest node to its destination is reached (remove from vehicle)
-    void DropOffPassenger(std::shared_ptr<Vehicle> vehicle);
+    void DropOffPassenger(int slot);
 
     // Variables
-    std::unordered_map<int, std::shared_ptr<Vehicle>> vehicles_;
+    VehicleFleet fleet_;
     std::unordered_map<int, std::shared_ptr<Passenger>> passenger_pickups_; // store passenger pickups for next cycle
     std::unordered_map<int, Coordinate> new_assignment_locations; // store new assignments for next cycle
     std::vector<int> to_remove_; // store vehicle ids of those to remove the next cycle (due to too many failures)
+    WakeSignal wake_signal_; // wakes the drive loop early for new assignments or pickups
+    int passengers_dropped_off_ = 0;
+    ThreadPool thread_pool_; // plans routes and moves vehicles in parallel
+    std::vector<int> to_plan_; // slots of vehicles needing a route this cycle
+    std::vector<std::vector<int>> planned_paths_; // routes found for to_plan_, kept to re-use their memory
+    std::vector<int> assignment_path_; // route to a newly assigned passenger, kept to re-use its memory
+    std::vector<char> route_failed_; // whether the vehicle in each slot failed to find a route this cycle
+    std::vector<char> reached_node_; // whether the vehicle in each slot drove onto a road node this cycle
+    std::vector<std::pair<int, int>> cycle_idle_road_nodes_; // (vehicle id, road node) idle changes found this cycle
+    std::unordered_map<int, int> idle_road_nodes_; // latest idle road node changes not yet taken by the ride matcher
     std::shared_ptr<RideMatcher> ride_matcher_;
     std::mutex passenger_pickups_mutex; // protect read/write access to passenger pickups between cycles
     std::mutex new_assignment_locations_mutex; // protect read/write access to new assignments between cycles
+    std::mutex idle_road_nodes_mutex; // protect read/write access to idle road node changes between cycles
 };
 
 }  // namespace rideshare
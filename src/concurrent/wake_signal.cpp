@@ -0,0 +1,39 @@
+/**
+ * @file wake_signal.cpp
+ * @brief Implementation of waking a sleeping thread on notification.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "wake_signal.h"
+
+namespace rideshare {
+
+void WakeSignal::Notify() {
+    // Only the first notification since the last wait needs to wake the thread
+    if (pending_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    // Lock so the waiter can't miss the notification between checking pending_ and sleeping
+    std::lock_guard<std::mutex> lck(mtx_);
+    cv_.notify_one();
+}
+
+void WakeSignal::Wait() {
+    std::unique_lock<std::mutex> lck(mtx_);
+    cv_.wait(lck, [this] { return pending_.load(std::memory_order_acquire); });
+    // Exchange rather than store, so everything sent before the latest notification is visible after
+    pending_.exchange(false, std::memory_order_acq_rel);
+}
+
+bool WakeSignal::WaitUntil(Clock::time_point deadline) {
+    std::unique_lock<std::mutex> lck(mtx_);
+    bool notified = cv_.wait_until(lck, deadline, [this] { return pending_.load(std::memory_order_acquire); });
+    if (notified) {
+        pending_.exchange(false, std::memory_order_acq_rel);
+    }
+    return notified;
+}
+
+}  // namespace rideshare
@@ -0,0 +1,40 @@
+/**
+ * @file wake_signal.h
+ * @brief Lets one thread sleep until another thread notifies it that there is work to do.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef WAKE_SIGNAL_H_
+#define WAKE_SIGNAL_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace rideshare {
+
+class WakeSignal {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // Primary functionality
+    // Wake the waiting thread (or make its next wait return right away), callable from any thread
+    void Notify();
+    // Sleep until notified, returning immediately if a notification is already pending
+    void Wait();
+    // Sleep until notified or the deadline passes, returning whether a notification was received
+    bool WaitUntil(Clock::time_point deadline);
+
+  private:
+    // Set by Notify and cleared by a wait, so a notification sent while not waiting isn't lost
+    std::atomic<bool> pending_{false};
+    std::mutex mtx_;
+    std::condition_variable cv_;
+};
+
+}  // namespace rideshare
+
+#endif  // WAKE_SIGNAL_H_
@@ -8,14 +8,17 @@
  *
  */
 
+#include <chrono>
 #include <cstdlib>
 #include <ctime>
-#include <optional>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <cmath>
 #include <memory>
+#include <optional>
 #include <set>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -24,24 +27,102 @@
 #include "concurrent/passenger_queue.h"
 #include "concurrent/ride_matcher.h"
 #include "concurrent/vehicle_manager.h"
+#include "mapping/map_cache.h"
 #include "mapping/route_model.h"
+#include "routing/contraction_hierarchy.h"
+#include "routing/landmarks.h"
 #include "routing/route_planner.h"
+#include "simulation/event_engine.h"
+#ifdef RIDESHARE_GRAPHICS
 #include "visual/graphics.h"
+#endif
+
+static constexpr int DEFAULT_HEADLESS_SECONDS = 60 * 60;
+
+static std::optional<rideshare::RouteModel> LoadModel(const std::string &osm_data_file, const std::string &map_cache_file,
+                                                      bool use_cache) {
+    // Use the compiled map data if available and made from the current OSM data, as it skips all OSM parsing
+    if ( use_cache ) {
+        rideshare::MapCache map_cache{map_cache_file, osm_data_file};
+        if ( map_cache.IsValid() ) {
+            std::cout << "Reading compiled map data from the following file: " << map_cache_file << std::endl;
+            try {
+                return rideshare::RouteModel{map_cache};
+            } catch ( const std::logic_error &error ) {
+                std::cout << "Failed to load map: " << error.what() << std::endl;
+                return std::nullopt;
+            }
+        }
+    }
 
-static std::optional<std::vector<std::byte>> ReadFile(const std::string &path) {   
-    std::ifstream is{path, std::ios::binary | std::ios::ate};
-    if ( !is )
+    // Stream through the OSM data file rather than reading it all into memory at once
+    std::cout << "Reading OpenStreetMap data from the following file: " <<  osm_data_file << std::endl;
+    std::ifstream osm_data{osm_data_file, std::ios::binary};
+    if ( !osm_data ) {
+        std::cout << "Failed to read." << std::endl;
         return std::nullopt;
-    
-    auto size = is.tellg();
-    std::vector<std::byte> contents(size);    
-    
-    is.seekg(0);
-    is.read((char*)contents.data(), size);
-
-    if ( contents.empty() )
+    }
+
+    try {
+        return rideshare::RouteModel{osm_data};
+    } catch ( const std::logic_error &error ) {
+        std::cout << "Failed to load map: " << error.what() << std::endl;
         return std::nullopt;
-    return std::move(contents);
+    }
+}
+
+static std::unique_ptr<rideshare::ContractionHierarchy> LoadHierarchy(const rideshare::RouteModel &model,
+                                                                     const std::string &hierarchy_file) {
+    // Contraction only needs to happen once per road graph, so use the file if it matches this one
+    std::unique_ptr<rideshare::ContractionHierarchy> hierarchy = rideshare::ContractionHierarchy::Read(model, hierarchy_file);
+    if ( hierarchy != nullptr ) {
+        std::cout << "Reading contraction hierarchy from the following file: " << hierarchy_file << std::endl;
+        return hierarchy;
+    }
+
+    std::cout << "Building contraction hierarchy..." << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    hierarchy = std::make_unique<rideshare::ContractionHierarchy>(model);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Added " << hierarchy->ShortcutCount() << " shortcuts in " << seconds << " s." << std::endl;
+    if ( hierarchy->Write(hierarchy_file) ) {
+        std::cout << "Contraction hierarchy written to: " << hierarchy_file << std::endl;
+    } else {
+        std::cout << "Failed to write contraction hierarchy to: " << hierarchy_file << std::endl;
+    }
+    return hierarchy;
+}
+
+static void RunEventSimulation(std::shared_ptr<rideshare::PassengerQueue> passengers,
+                               std::shared_ptr<rideshare::VehicleManager> vehicles,
+                               std::shared_ptr<rideshare::RideMatcher> ride_matcher,
+                               int sim_seconds) {
+    rideshare::EventEngine engine;
+    const int64_t CYCLE_MS = rideshare::ConcurrentObject::CYCLE_DURATION_.count();
+
+    // Every cycle, step each part of the simulation in a fixed order
+    std::function<void()> cycle = [&]() {
+        vehicles->Step();
+        passengers->Step();
+        ride_matcher->Step();
+        engine.ScheduleAfter(CYCLE_MS, cycle);
+    };
+    // Passenger generation happens at its own random intervals
+    std::function<void()> generation = [&]() {
+        passengers->GenerationStep();
+        engine.ScheduleAfter(passengers->GenerationWait(), generation);
+    };
+    engine.Schedule(0, cycle);
+    engine.ScheduleAfter(passengers->GenerationWait(), generation);
+
+    auto start = std::chrono::steady_clock::now();
+    engine.RunUntil((int64_t)sim_seconds * 1000);
+    double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Simulated " << sim_seconds << " s in " << wall_seconds << " s (" << engine.EventsRun() << " events)." << std::endl;
+    std::cout << "Passengers generated: " << passengers->PassengersGenerated()
+              << ", matched: " << ride_matcher->MatchesMade()
+              << ", dropped off: " << vehicles->PassengersDroppedOff() << "." << std::endl;
 }
 
 int main(int argc, char *argv[]) {
@@ -50,25 +131,50 @@ int main(int argc, char *argv[]) {
 
     // Get map data
     const std::string osm_data_file = "../data/" + settings["map"] + ".osm";
-    std::vector<std::byte> osm_data;
- 
-    if ( osm_data.empty() && !osm_data_file.empty() ) {
-        std::cout << "Reading OpenStreetMap data from the following file: " <<  osm_data_file << std::endl;
-        auto data = ReadFile(osm_data_file);
-        if ( !data ) {
-            std::cout << "Failed to read." << std::endl;
-        } else {
-            osm_data = std::move(*data);
+    const std::string map_cache_file = "../data/" + settings["map"] + ".mapcache";
+    const std::string hierarchy_file = "../data/" + settings["map"] + ".ch";
+    const bool compile_map = settings["compile_map"] == "true";
+
+    std::optional<rideshare::RouteModel> loaded_model = LoadModel(osm_data_file, map_cache_file, !compile_map);
+    if ( !loaded_model ) {
+        return 1;
+    }
+    rideshare::RouteModel &model = *loaded_model;
+
+    // Only write out the compiled map data if requested
+    if ( compile_map ) {
+        if ( !rideshare::MapCache::Write(model, map_cache_file, osm_data_file) ) {
+            std::cout << "Failed to write compiled map data to: " << map_cache_file << std::endl;
+            return 1;
         }
+        std::cout << "Compiled map data written to: " << map_cache_file << std::endl;
+        return 0;
     }
 
-    rideshare::RouteModel model{osm_data};
+    // Without graphics, always run on a virtual clock (for an hour, unless told otherwise)
+#ifdef RIDESHARE_GRAPHICS
+    const bool headless = settings["headless"] == "true";
+#else
+    const bool headless = true;
+#endif
+    int sim_seconds = std::stoi(settings["sim_seconds"]);
+    if ( headless && sim_seconds == 0 ) {
+        sim_seconds = DEFAULT_HEADLESS_SECONDS;
+    }
 
-    srand((unsigned) time(NULL)); // Seed random number generator
+    // Seed random number generator, with a fixed seed for simulated-time runs so they are repeatable
+    srand(sim_seconds > 0 ? 1u : (unsigned) time(NULL));
 
     // Create a shared route planner
     std::shared_ptr<rideshare::RoutePlanner> route_planner =
       std::make_shared<rideshare::RoutePlanner>(model);
+    if ( settings["algorithm"] == "ch" ) {
+        route_planner->SetContractionHierarchy(LoadHierarchy(model, hierarchy_file));
+    } else if ( settings["algorithm"] == "alt" ) {
+        route_planner->SetLandmarks(std::make_unique<rideshare::Landmarks>(model));
+    } else if ( settings["algorithm"] == "bidir" ) {
+        route_planner->SetBidirectional(true);
+    }
 
     // Create vehicles
     std::shared_ptr<rideshare::VehicleManager> vehicles =
@@ -79,17 +185,21 @@ int main(int argc, char *argv[]) {
       std::make_shared<rideshare::PassengerQueue>(&model, route_planner, std::stoi(settings["passengers"]),
                                                   std::stoi(settings["wait"]), std::stoi(settings["wait_range"]));
 
-    // Calculate the average map dimension used by the ride matcher
-    const double MAP_DIM = (std::abs(model.MaxLat() - model.MinLat()) + std::abs(model.MaxLon() - model.MinLon())) / 2.0;
-
     // Create the ride matcher
     std::shared_ptr<rideshare::RideMatcher> ride_matcher =
-      std::make_shared<rideshare::RideMatcher>(passengers, vehicles, MAP_DIM, settings["match"]);
+      std::make_shared<rideshare::RideMatcher>(&model, route_planner, passengers, vehicles, settings["match"]);
 
     // Attach ride matcher to the other two
     vehicles->SetRideMatcher(ride_matcher);
     passengers->SetRideMatcher(ride_matcher);
 
+    // Run on a virtual clock instead, if a simulated duration was given
+    if ( sim_seconds > 0 ) {
+        RunEventSimulation(passengers, vehicles, ride_matcher, sim_seconds);
+        return 0;
+    }
+
+#ifdef RIDESHARE_GRAPHICS
     // Start the simulations
     ride_matcher->Simulate();
     vehicles->Simulate();
@@ -103,6 +213,7 @@ int main(int argc, char *argv[]) {
     graphics->SetPassengers(passengers);
     graphics->SetVehicles(vehicles);
     graphics->Simulate();
+#endif
 
     return 0;
 }
@@ -11,6 +11,7 @@
 
 #include <cmath>
 #include <cstdlib>
+#include <utility>
 #include <vector>
 
 #include "mapping/coordinate.h"
@@ -41,14 +42,16 @@ class MapObject {
     void SetDestination(const Coordinate &destination) { destination_ = destination; }
     void SetColors(int blue, int green, int red) { blue_ = blue; green_ = green; red_ = red; }
     void SetId(int id) { id_ = id; }
-    void SetPath(std::vector<Model::Node> path) { path_ = path; }
+    void SetPath(std::vector<int> path) { path_ = std::move(path); }
     Coordinate GetPosition() { return position_; }
     Coordinate GetDestination() { return destination_; }
     int Blue() { return blue_; }
     int Green() { return green_; }
     int Red() { return red_; }
     int Id() { return id_; }
-    std::vector<Model::Node> Path() { return path_; }
+    const std::vector<int> &Path() const { return path_; }
+    // Path to be filled in place by the route planner
+    std::vector<int> &PathBuffer() { return path_; }
 
     // Movement
     virtual void IncrementalMove() {};
@@ -76,7 +79,7 @@ class MapObject {
     Coordinate position_;
     Coordinate destination_;
     int blue_, green_, red_; // Visualization colors
-    std::vector<Model::Node> path_; // path made by route planner from start position to destination
+    std::vector<int> path_; // road node indices of path made by route planner from start position to destination
   
   private:
     // Set visualization colors out of 255
@@ -0,0 +1,173 @@
+/**
+ * @file vehicle_fleet.cpp
+ * @brief Implementation of the vehicle fleet, particularly handling position, path and passengers.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "vehicle_fleet.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+namespace rideshare {
+
+int VehicleFleet::Add(int id, const Coordinate &position, const Coordinate &destination) {
+    std::unique_lock<std::shared_mutex> lck(mtx_);
+    int slot = ids_.size();
+    ids_.emplace_back(id);
+    positions_.emplace_back(position);
+    destinations_.emplace_back(destination);
+    states_.emplace_back(VehicleState::no_passenger_requested);
+    path_starts_.emplace_back(0);
+    path_lengths_.emplace_back(0);
+    path_capacities_.emplace_back(0);
+    path_indices_.emplace_back(0);
+    road_nodes_.emplace_back(NONE);
+    failures_.emplace_back(0);
+    // Random visualization colors out of 255
+    Color color;
+    color.blue = (uint8_t)(((float) rand() / RAND_MAX) * 255);
+    color.green = (uint8_t)(((float) rand() / RAND_MAX) * 255);
+    color.red = (uint8_t)(((float) rand() / RAND_MAX) * 255);
+    colors_.emplace_back(color);
+    passengers_.emplace_back();
+    if (id >= static_cast<int>(slots_.size())) {
+        slots_.resize(id + 1, NONE);
+    }
+    slots_[id] = slot;
+    return slot;
+}
+
+void VehicleFleet::Remove(int id) {
+    int slot = Slot(id);
+    if (slot == NONE) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lck(mtx_);
+    // The removed vehicle's path room is left unused until the next compaction
+    unused_path_room_ += path_capacities_[slot];
+    // Move the last vehicle into the removed one's slot, then drop the last slot
+    int last = ids_.size() - 1;
+    if (slot != last) {
+        ids_[slot] = ids_[last];
+        positions_[slot] = positions_[last];
+        destinations_[slot] = destinations_[last];
+        states_[slot] = states_[last];
+        path_starts_[slot] = path_starts_[last];
+        path_lengths_[slot] = path_lengths_[last];
+        path_capacities_[slot] = path_capacities_[last];
+        path_indices_[slot] = path_indices_[last];
+        road_nodes_[slot] = road_nodes_[last];
+        failures_[slot] = failures_[last];
+        colors_[slot] = colors_[last];
+        passengers_[slot] = std::move(passengers_[last]);
+        slots_[ids_[slot]] = slot;
+    }
+    ids_.pop_back();
+    positions_.pop_back();
+    destinations_.pop_back();
+    states_.pop_back();
+    path_starts_.pop_back();
+    path_lengths_.pop_back();
+    path_capacities_.pop_back();
+    path_indices_.pop_back();
+    road_nodes_.pop_back();
+    failures_.pop_back();
+    colors_.pop_back();
+    passengers_.pop_back();
+    slots_[id] = NONE;
+}
+
+void VehicleFleet::SetPosition(int slot, const Coordinate &position) {
+    positions_[slot] = position;
+    // If there is a passenger, match to the vehicle's position
+    if (passengers_[slot] != nullptr) {
+        passengers_[slot]->SetPosition(position);
+    }
+}
+
+void VehicleFleet::SetDestination(int slot, const Coordinate &destination) {
+    destinations_[slot] = destination;
+    // Reset the path and index so will properly route on a new path
+    path_lengths_[slot] = 0;
+    path_indices_[slot] = 0;
+}
+
+void VehicleFleet::SetPath(int slot, const std::vector<int> &path) {
+    int length = path.size();
+    if (length > path_capacities_[slot]) {
+        // Doesn't fit in its old room, so give it new room at the end of the pool
+        unused_path_room_ += path_capacities_[slot];
+        path_starts_[slot] = path_pool_.size();
+        path_capacities_[slot] = length;
+        path_pool_.resize(path_pool_.size() + length);
+    }
+    std::copy(path.begin(), path.end(), path_pool_.begin() + path_starts_[slot]);
+    path_lengths_[slot] = length;
+    path_indices_[slot] = 0;
+    // Keep the pool from growing without bound as paths move to new room
+    if (unused_path_room_ > static_cast<int>(path_pool_.size()) / 2) {
+        CompactPaths();
+    }
+}
+
+void VehicleFleet::CompactPaths() {
+    std::vector<int> compacted;
+    compacted.reserve(path_pool_.size() - unused_path_room_);
+    for (std::size_t slot = 0; slot < ids_.size(); ++slot) {
+        int start = compacted.size();
+        compacted.insert(compacted.end(), path_pool_.begin() + path_starts_[slot],
+                         path_pool_.begin() + path_starts_[slot] + path_capacities_[slot]);
+        path_starts_[slot] = start;
+    }
+    path_pool_.swap(compacted);
+    unused_path_room_ = 0;
+}
+
+void VehicleFleet::SetPassenger(int slot, std::shared_ptr<Passenger> passenger) {
+    // Set passenger's destination as the vehicle's destination
+    SetDestination(slot, passenger->GetDestination());
+    std::unique_lock<std::shared_mutex> lck(mtx_);
+    passengers_[slot] = std::move(passenger);
+}
+
+void VehicleFleet::DropOffPassenger(int slot) {
+    // Clear out the passenger
+    std::unique_lock<std::shared_mutex> lck(mtx_);
+    passengers_[slot].reset();
+    // Clear out failures as well, since had a successful ride
+    failures_[slot] = 0;
+}
+
+bool VehicleFleet::IncrementalMove(int slot) {
+    if (path_indices_[slot] >= path_lengths_[slot]) {
+        // Already at the end of its path
+        return false;
+    }
+    int next_idx = PathNode(slot, path_indices_[slot]);
+    const RouteModel::Node &next_pos = model_->SNodes()[next_idx];
+    Coordinate &position = positions_[slot];
+    // Check distance to next position vs. distance can go b/w timesteps
+    double distance = std::sqrt(std::pow(next_pos.x - position.x, 2) + std::pow(next_pos.y - position.y, 2));
+
+    if (distance <= distance_per_cycle_) {
+        // Don't need to calculate intermediate point, just set position as next_pos
+        SetPosition(slot, (Coordinate){.x = next_pos.x, .y = next_pos.y});
+        road_nodes_[slot] = next_idx;
+        ++path_indices_[slot];
+        return true;
+    }
+    // Calculate an intermediate position
+    double angle = std::atan2(next_pos.y - position.y, next_pos.x - position.x); // angle from x-axis
+    SetPosition(slot, (Coordinate){.x = position.x + (distance_per_cycle_ * std::cos(angle)),
+                                   .y = position.y + (distance_per_cycle_ * std::sin(angle))});
+    return false;
+}
+
+}  // namespace rideshare
@@ -0,0 +1,131 @@
+/**
+ * @file vehicle_fleet.h
+ * @brief All vehicles on the map, stored as parallel arrays; shown on the map.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef VEHICLE_FLEET_H_
+#define VEHICLE_FLEET_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "map_object.h"
+#include "passenger.h"
+#include "mapping/coordinate.h"
+#include "mapping/route_model.h"
+
+namespace rideshare {
+
+enum VehicleState {
+    no_passenger_requested,
+    no_passenger_queued,
+    passenger_queued,
+    waiting,
+    driving_passenger,
+};
+
+// Each vehicle lives in a slot, with one array per field so per-cycle loops over a single field
+//  (e.g. positions) read contiguous memory. Removing a vehicle moves the last one into its slot,
+//  so slots are only stable until the next Remove; use the vehicle's id to find it again after.
+// Only the owning thread changes the fleet. Other threads hold ReadLock() while reading it, as adding
+//  or removing a vehicle (re-allocating or swapping slots) and setting or dropping off a passenger
+//  (swapping a shared pointer) wait for readers, and readers for them. The owner holds WriteLock()
+//  while moving vehicles, so positions are never read mid-update.
+class VehicleFleet {
+  public:
+    static constexpr int NONE = -1;
+    static constexpr int SHAPE = DrawMarker::square;
+
+    // Constructors / Destructors
+    VehicleFleet(const RouteModel *model, double distance_per_cycle) : model_(model), distance_per_cycle_(distance_per_cycle) {}
+
+    // Slots & ids
+    // Add a vehicle with the given id (not already in the fleet), returning its slot
+    int Add(int id, const Coordinate &position, const Coordinate &destination);
+    // Remove the vehicle with the given id, if present
+    void Remove(int id);
+    // Slot of the vehicle with the given id, or NONE if not in the fleet
+    int Slot(int id) const { return (id >= 0 && id < static_cast<int>(slots_.size())) ? slots_[id] : NONE; }
+    int Size() const { return ids_.size(); }
+    int Id(int slot) const { return ids_[slot]; }
+    // Keep the fleet's slots and passengers from changing while held (for threads other than the owner)
+    std::shared_lock<std::shared_mutex> ReadLock() const { return std::shared_lock<std::shared_mutex>(mtx_); }
+    // Keep other threads' reads out while held (for the owner, around moves; not needed by the methods that lock)
+    std::unique_lock<std::shared_mutex> WriteLock() { return std::unique_lock<std::shared_mutex>(mtx_); }
+
+    // Getters / Setters (by slot)
+    const Coordinate &Position(int slot) const { return positions_[slot]; }
+    const Coordinate &Destination(int slot) const { return destinations_[slot]; }
+    VehicleState State(int slot) const { return (VehicleState)states_[slot]; }
+    // Road node indices of the path made by the route planner from position to destination (empty if none yet)
+    int PathLength(int slot) const { return path_lengths_[slot]; }
+    int PathNode(int slot, int i) const { return path_pool_[path_starts_[slot] + i]; }
+    int PathIndex(int slot) const { return path_indices_[slot]; }
+    // Road node the vehicle last drove onto, or NONE if it has not reached one yet
+    int RoadNode(int slot) const { return road_nodes_[slot]; }
+    const std::shared_ptr<Passenger> &GetPassenger(int slot) const { return passengers_[slot]; }
+    int Blue(int slot) const { return colors_[slot].blue; }
+    int Green(int slot) const { return colors_[slot].green; }
+    int Red(int slot) const { return colors_[slot].red; }
+    void SetState(int slot, VehicleState state) { states_[slot] = state; }
+    // Copy in a new path, in place of the vehicle's earlier one if it fits there
+    void SetPath(int slot, const std::vector<int> &path);
+    // Also moves any passenger in the vehicle along with it
+    void SetPosition(int slot, const Coordinate &position);
+    // Also clears the path, so the vehicle gets a new route to the destination
+    void SetDestination(int slot, const Coordinate &destination);
+    // Put a passenger in the vehicle, heading to the passenger's destination
+    void SetPassenger(int slot, std::shared_ptr<Passenger> passenger);
+
+    // Other functionality
+    // "Drop off" the passenger - remove the passenger and reset any failures
+    void DropOffPassenger(int slot);
+    // Count a failure (such as destination can't be reached), returning true if the vehicle should be removed
+    bool MovementFailure(int slot) { return ++failures_[slot] >= MAX_FAILURES_; }
+    // Movement, one cycle along the path; returns true if the vehicle drove onto its next road node
+    bool IncrementalMove(int slot);
+
+  private:
+    struct Color {
+        uint8_t blue;
+        uint8_t green;
+        uint8_t red;
+    };
+
+    // Pack the paths back to back at the start of the pool, dropping room no slot uses
+    void CompactPaths();
+
+    const RouteModel *model_; // road nodes that paths index into
+    mutable std::shared_mutex mtx_; // held exclusively for Add, Remove, SetPassenger and DropOffPassenger
+    const double distance_per_cycle_; // max distance to move per cycle for smooth-looking movement
+    const int MAX_FAILURES_ = 10; // max failures before vehicle will be removed (likely stuck)
+
+    // Indexed by slot
+    std::vector<int> ids_;
+    std::vector<Coordinate> positions_;
+    std::vector<Coordinate> destinations_;
+    std::vector<uint8_t> states_;
+    std::vector<int> path_starts_; // where each path begins in path_pool_
+    std::vector<int> path_lengths_;
+    std::vector<int> path_capacities_; // room at path_starts_, so a path no longer than this is copied in place
+    std::vector<int> path_indices_;
+    std::vector<int> road_nodes_;
+    std::vector<int> failures_;
+    std::vector<Color> colors_;
+    std::vector<std::shared_ptr<Passenger>> passengers_;
+    // Indexed by id (ids are handed out in increasing order, so this stays dense)
+    std::vector<int> slots_;
+    // Every slot's path back to back, so moving the fleet reads one array rather than one allocation per vehicle
+    std::vector<int> path_pool_;
+    int unused_path_room_ = 0; // entries of path_pool_ no slot uses any more
+};
+
+}  // namespace rideshare
+
+#endif  // VEHICLE_FLEET_H_
@@ -0,0 +1,63 @@
+/**
+ * @file alias_table.cpp
+ * @brief Implementation of building and sampling from an alias table (Vose's method).
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "alias_table.h"
+
+#include <vector>
+
+namespace rideshare {
+
+AliasTable::AliasTable(const std::vector<double> &weights) {
+    int count = weights.size();
+    double total = 0.0;
+    for (double weight : weights) {
+        total += weight;
+    }
+    if (count == 0 || total <= 0.0) {
+        return;
+    }
+
+    // Scale weights so the average is 1, then split indices into those under and over average
+    probabilities_.resize(count);
+    aliases_.assign(count, 0);
+    std::vector<int> small, large;
+    for (int i = 0; i < count; ++i) {
+        probabilities_[i] = weights[i] * count / total;
+        if (probabilities_[i] < 1.0) {
+            small.emplace_back(i);
+        } else {
+            large.emplace_back(i);
+        }
+    }
+    // Fill each under-average index up to 1 with the remainder of an over-average one
+    while (!small.empty() && !large.empty()) {
+        int under = small.back();
+        small.pop_back();
+        int over = large.back();
+        aliases_[under] = over;
+        probabilities_[over] -= 1.0 - probabilities_[under];
+        if (probabilities_[over] < 1.0) {
+            large.pop_back();
+            small.emplace_back(over);
+        }
+    }
+    // Anything left over is only off from 1 due to rounding
+    for (int i : small) {
+        probabilities_[i] = 1.0;
+    }
+    for (int i : large) {
+        probabilities_[i] = 1.0;
+    }
+}
+
+int AliasTable::Sample(double pick, double coin) const {
+    int i = pick * probabilities_.size();
+    return (coin < probabilities_[i]) ? i : aliases_[i];
+}
+
+}  // namespace rideshare
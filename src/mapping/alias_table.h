@@ -0,0 +1,39 @@
+/**
+ * @file alias_table.h
+ * @brief Walker's alias method, for drawing weighted random indices in constant time.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef ALIAS_TABLE_H_
+#define ALIAS_TABLE_H_
+
+#include <vector>
+
+namespace rideshare {
+
+class AliasTable {
+  public:
+    // Constructors / Destructors
+    AliasTable() {};
+    // Build the table from non-negative weights, one per index
+    AliasTable(const std::vector<double> &weights);
+
+    // Getters / Setters
+    bool Empty() const { return probabilities_.empty(); }
+    int Size() const { return probabilities_.size(); }
+
+    // Primary functionality
+    // Index drawn with probability proportional to its weight, given two uniform values in [0, 1)
+    int Sample(double pick, double coin) const;
+
+  private:
+    // Each index keeps itself with its probability, otherwise gives way to its alias
+    std::vector<double> probabilities_;
+    std::vector<int> aliases_;
+};
+
+}  // namespace rideshare
+
+#endif  // ALIAS_TABLE_H_
@@ -0,0 +1,175 @@
+/**
+ * @file map_cache.cpp
+ * @brief Implementation of writing and reading binary road graph caches.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "map_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <vector>
+
+#include "route_model.h"
+
+namespace rideshare {
+
+static const char MAGIC[8] = {'R', 'S', 'M', 'A', 'P', 'B', 'I', 'N'};
+
+// Sections are stored raw, so their layouts must be plain and fixed
+static_assert(sizeof(Model::Node) == 2 * sizeof(double), "unexpected Model::Node layout");
+static_assert(sizeof(Model::Road) == 2 * sizeof(std::int32_t), "unexpected Model::Road layout");
+static_assert(sizeof(int) == sizeof(std::int32_t), "unexpected int size");
+
+// Round a section size up so the next section stays 8-byte aligned
+static std::size_t Aligned(std::size_t bytes) {
+    return (bytes + 7) & ~static_cast<std::size_t>(7);
+}
+
+// Write a section followed by any padding needed for alignment
+static void WriteSection(std::ofstream &out, const void *data, std::size_t bytes) {
+    static const char padding[8] = {};
+    out.write(static_cast<const char *>(data), bytes);
+    out.write(padding, Aligned(bytes) - bytes);
+}
+
+// Size and last write time of the OSM file a cache is made from, returning false if it can't be read
+static bool SourceStamp(const std::string &source_path, std::uint64_t &size, std::int64_t &mtime) {
+    std::error_code error;
+    size = std::filesystem::file_size(source_path, error);
+    if (error) {
+        return false;
+    }
+    mtime = std::filesystem::last_write_time(source_path, error).time_since_epoch().count();
+    return !error;
+}
+
+MapCache::MapCache(const std::string &path, const std::string &source_path) {
+    std::ifstream in{path, std::ios::binary | std::ios::ate};
+    if (!in) {
+        return;
+    }
+    std::size_t file_size = in.tellg();
+    in.seekg(0);
+    valid_ = ReadSections(in, file_size, source_path);
+}
+
+// Read a section and skip any padding after it
+template <typename T>
+static bool ReadSection(std::istream &in, std::vector<T> &section, std::size_t count) {
+    section.resize(count);
+    std::size_t bytes = count * sizeof(T);
+    in.read(reinterpret_cast<char *>(section.data()), bytes);
+    in.ignore(Aligned(bytes) - bytes);
+    return static_cast<bool>(in);
+}
+
+bool MapCache::ReadSections(std::istream &in, std::size_t file_size, const std::string &source_path) {
+    if (file_size < sizeof(Header) || !in.read(reinterpret_cast<char *>(&header_), sizeof(Header)) ||
+        std::memcmp(header_.magic, MAGIC, sizeof(MAGIC)) != 0 || header_.version != VERSION) {
+        return false;
+    }
+
+    // A cache of an edited (or missing) OSM file is stale
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    if (!SourceStamp(source_path, source_size, source_mtime) || source_size != header_.source_size ||
+        source_mtime != header_.source_mtime) {
+        return false;
+    }
+
+    // Check the sections add up to the file size before allocating anything for them
+    std::size_t expected_size = Aligned(sizeof(Header)) +
+        Aligned(header_.node_count * sizeof(Model::Node)) +
+        Aligned((header_.way_count + 1) * sizeof(std::int32_t)) +
+        Aligned(header_.way_node_count * sizeof(std::int32_t)) +
+        Aligned(header_.road_count * sizeof(Model::Road)) +
+        Aligned((header_.node_count + 1) * sizeof(std::int32_t)) +
+        Aligned(header_.edge_count * sizeof(std::int32_t)) +
+        Aligned(header_.edge_count * sizeof(float));
+    if (expected_size != file_size) {
+        return false;
+    }
+    in.ignore(Aligned(sizeof(Header)) - sizeof(Header));
+
+    return ReadSection(in, nodes_, header_.node_count) &&
+           ReadSection(in, way_offsets_, header_.way_count + 1) &&
+           ReadSection(in, way_nodes_, header_.way_node_count) &&
+           ReadSection(in, roads_, header_.road_count) &&
+           ReadSection(in, edge_offsets_, header_.node_count + 1) &&
+           ReadSection(in, edge_targets_, header_.edge_count) &&
+           ReadSection(in, edge_lengths_, header_.edge_count) &&
+           IndicesInRange();
+}
+
+// Offsets must run in order from 0 to the size of the section they index into
+static bool OffsetsValid(const std::vector<std::int32_t> &offsets, std::uint64_t section_size) {
+    return offsets.front() == 0 && (std::uint64_t)offsets.back() == section_size &&
+           std::is_sorted(offsets.begin(), offsets.end());
+}
+
+// Indices must all be in [0, count)
+static bool IndicesValid(const std::vector<std::int32_t> &indices, std::uint64_t count) {
+    return std::all_of(indices.begin(), indices.end(), [count](std::int32_t idx) {
+        return idx >= 0 && (std::uint64_t)idx < count;
+    });
+}
+
+bool MapCache::IndicesInRange() const {
+    bool roads_valid = std::all_of(roads_.begin(), roads_.end(), [this](const Model::Road &road) {
+        return road.way >= 0 && (std::uint64_t)road.way < header_.way_count &&
+               road.type > Model::Road::Invalid && road.type <= Model::Road::Motorway;
+    });
+    return roads_valid &&
+           OffsetsValid(way_offsets_, header_.way_node_count) && IndicesValid(way_nodes_, header_.node_count) &&
+           OffsetsValid(edge_offsets_, header_.edge_count) && IndicesValid(edge_targets_, header_.node_count);
+}
+
+bool MapCache::Write(const RouteModel &model, const std::string &path, const std::string &source_path) {
+    Header header{};
+    if (!SourceStamp(source_path, header.source_size, header.source_mtime)) {
+        return false;
+    }
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    if (!out) {
+        return false;
+    }
+
+    // Flatten way node lists into offsets + indices
+    std::vector<std::int32_t> way_offsets{0};
+    std::vector<std::int32_t> way_nodes;
+    for (const Model::Way &way : model.Ways()) {
+        way_nodes.insert(way_nodes.end(), way.nodes.begin(), way.nodes.end());
+        way_offsets.emplace_back(way_nodes.size());
+    }
+
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.min_lat = model.MinLat();
+    header.max_lat = model.MaxLat();
+    header.min_lon = model.MinLon();
+    header.max_lon = model.MaxLon();
+    header.node_count = model.Nodes().size();
+    header.way_count = model.Ways().size();
+    header.way_node_count = way_nodes.size();
+    header.road_count = model.Roads().size();
+    header.edge_count = model.EdgeTargets().size();
+
+    WriteSection(out, &header, sizeof(header));
+    WriteSection(out, model.Nodes().data(), model.Nodes().size() * sizeof(Model::Node));
+    WriteSection(out, way_offsets.data(), way_offsets.size() * sizeof(std::int32_t));
+    WriteSection(out, way_nodes.data(), way_nodes.size() * sizeof(std::int32_t));
+    WriteSection(out, model.Roads().data(), model.Roads().size() * sizeof(Model::Road));
+    WriteSection(out, model.EdgeOffsets().data(), model.EdgeOffsets().size() * sizeof(std::int32_t));
+    WriteSection(out, model.EdgeTargets().data(), model.EdgeTargets().size() * sizeof(std::int32_t));
+    WriteSection(out, model.EdgeLengths().data(), model.EdgeLengths().size() * sizeof(float));
+
+    return static_cast<bool>(out);
+}
+
+}  // namespace rideshare
@@ -0,0 +1,85 @@
+/**
+ * @file map_cache.h
+ * @brief Versioned binary cache of a processed road graph, read straight into the road graph arrays.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef MAP_CACHE_H_
+#define MAP_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "model.h"
+
+// Avoid circular includes
+namespace rideshare {
+    class RouteModel;
+}
+
+namespace rideshare {
+
+class MapCache {
+  public:
+    // Bump whenever the file layout or the processing of OSM data changes
+    static constexpr std::uint32_t VERSION = 3;
+
+    // Fixed-size start of the file; the sections below follow in order, each 8-byte aligned
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+        std::uint64_t source_size;    // size and last write time of the OSM file the cache was made from,
+        std::int64_t source_mtime;    //  so a cache of an older version of the map is not used
+        double min_lat, max_lat, min_lon, max_lon;
+        std::uint64_t node_count;     // Model::Node (x, y) per node
+        std::uint64_t way_count;      // way_count + 1 offsets into the way node indices
+        std::uint64_t way_node_count; // way node indices
+        std::uint64_t road_count;     // Model::Road per road
+        std::uint64_t edge_count;     // node_count + 1 edge offsets, then edge targets and edge lengths
+    };
+
+    // Constructors / Destructors
+    // Read a cache file made from the given OSM file; check IsValid() before using its sections
+    MapCache(const std::string &path, const std::string &source_path);
+
+    // Write the processed road graph of a model, made from the given OSM file, to a cache file
+    static bool Write(const RouteModel &model, const std::string &path, const std::string &source_path);
+
+    // Getters
+    bool IsValid() const { return valid_; }
+    const Header &GetHeader() const { return header_; }
+    // Sections are read into the arrays the models keep, so a model built from the cache
+    //  can move them out instead of copying (leaving the cache's sections empty)
+    std::vector<Model::Node> &Nodes() { return nodes_; }
+    const std::vector<std::int32_t> &WayOffsets() const { return way_offsets_; }
+    const std::vector<std::int32_t> &WayNodes() const { return way_nodes_; }
+    std::vector<Model::Road> &Roads() { return roads_; }
+    std::vector<int> &EdgeOffsets() { return edge_offsets_; }
+    std::vector<int> &EdgeTargets() { return edge_targets_; }
+    std::vector<float> &EdgeLengths() { return edge_lengths_; }
+
+  private:
+    // Read each section in order, returning false if the file doesn't match its header or source
+    bool ReadSections(std::istream &in, std::size_t file_size, const std::string &source_path);
+    // Check every index in the sections points inside the section it indexes into
+    bool IndicesInRange() const;
+
+    bool valid_ = false;
+    Header header_{};
+    std::vector<Model::Node> nodes_;
+    std::vector<std::int32_t> way_offsets_;
+    std::vector<std::int32_t> way_nodes_;
+    std::vector<Model::Road> roads_;
+    std::vector<int> edge_offsets_;
+    std::vector<int> edge_targets_;
+    std::vector<float> edge_lengths_;
+};
+
+}  // namespace rideshare
+
+#endif  // MAP_CACHE_H_
@@ -14,10 +14,14 @@
 #include <cstdlib>
 #include <algorithm>
 #include <assert.h>
-
-#include "pugixml.hpp"
+#include <stdexcept>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 #include "coordinate.h"
+#include "map_cache.h"
+#include "osm_reader.h"
 
 namespace rideshare {
 
@@ -33,15 +37,32 @@ static Model::Road::Type String2RoadType(std::string_view type) {
     return Model::Road::Invalid; // don't want other road types
 }
 
-Model::Model(const std::vector<std::byte> &xml) {
+Model::Model(std::istream &osm_data) {
     
-    LoadData(xml);
+    LoadData(osm_data);
 
     std::sort(roads_.begin(), roads_.end(), [](const auto &_1st, const auto &_2nd) {
         return (int)_1st.type < (int)_2nd.type; 
     });
 }
 
+Model::Model(MapCache &cache) {
+    const MapCache::Header &header = cache.GetHeader();
+    min_lat_ = header.min_lat;
+    max_lat_ = header.max_lat;
+    min_lon_ = header.min_lon;
+    max_lon_ = header.max_lon;
+
+    nodes_ = std::move(cache.Nodes());
+    ways_.resize(header.way_count);
+    for (std::size_t i = 0; i < ways_.size(); ++i) {
+        ways_[i].nodes.assign(cache.WayNodes().begin() + cache.WayOffsets()[i],
+                              cache.WayNodes().begin() + cache.WayOffsets()[i + 1]);
+    }
+    // Roads were already sorted by type before being cached
+    roads_ = std::move(cache.Roads());
+}
+
 Coordinate Model::GetRandomMapPosition() const noexcept {
     // Get float values as percentages of map to use
     float randPercentageLon = (float) rand() / RAND_MAX;
@@ -50,58 +71,100 @@ Coordinate Model::GetRandomMapPosition() const noexcept {
                          .y = ((max_lat_ - min_lat_) * randPercentageLat) + min_lat_ };
 }
 
-void Model::LoadData(const std::vector<std::byte> &xml) {
-    using namespace pugi;
-    
-    xml_document doc;
-    if ( !doc.load_buffer(xml.data(), xml.size()) )
-        throw std::logic_error("failed to parse the xml file");
-    
-    if ( auto bounds = doc.select_nodes("/osm/bounds"); !bounds.empty() ) {
-        auto node = bounds.first().node();
-        min_lat_ = atof(node.attribute("minlat").as_string());
-        max_lat_ = atof(node.attribute("maxlat").as_string());
-        min_lon_ = atof(node.attribute("minlon").as_string());
-        max_lon_ = atof(node.attribute("maxlon").as_string());
-    } else {
-        throw std::logic_error("map's bounds are not defined");
-    }
+void Model::LoadData(std::istream &osm_data) {
+    OsmReader reader{osm_data};
+    bool root_is_osm = false;
+    bool has_bounds = false;
+    bool in_way = false;
+    Road::Type way_type = Road::Invalid; // road type of the way currently being read, if any
+
+    // Nodes and road node refs are held by OSM id until all are read, as only nodes used by roads are kept
+    struct OsmNode {
+        std::int64_t id;
+        Node node;
+    };
+    std::vector<OsmNode> osm_nodes;
+    std::vector<std::int64_t> way_refs; // node ids of the way currently being read
+    std::vector<std::int64_t> road_refs; // node ids of all roads, one after another
+    std::vector<std::size_t> road_ref_offsets{0};
+    std::vector<Road::Type> road_types;
 
-    std::unordered_map<std::string, int> node_id_to_num;
-    for ( const auto &node: doc.select_nodes("/osm/node") ) {
-        node_id_to_num[node.node().attribute("id").as_string()] = (int)nodes_.size();
-        nodes_.emplace_back();        
-        nodes_.back().y = atof(node.node().attribute("lat").as_string());
-        nodes_.back().x = atof(node.node().attribute("lon").as_string());
+    while ( reader.Next() ) {
+        auto name = reader.Name();
+        if ( reader.Event() == OsmReader::end_element ) {
+            if ( reader.Depth() == 1 && name == "way" ) {
+                // Only keep ways that are roads
+                if ( way_type != Road::Invalid ) {
+                    road_refs.insert(road_refs.end(), way_refs.begin(), way_refs.end());
+                    road_ref_offsets.emplace_back(road_refs.size());
+                    road_types.emplace_back(way_type);
+                }
+                in_way = false;
+            }
+            continue;
+        }
+
+        if ( reader.Depth() == 0 ) {
+            root_is_osm = name == "osm";
+        } else if ( !root_is_osm ) {
+            continue;
+        } else if ( reader.Depth() == 1 ) {
+            if ( name == "bounds" && !has_bounds ) {
+                has_bounds = true;
+                min_lat_ = atof(reader.Attribute("minlat").data());
+                max_lat_ = atof(reader.Attribute("maxlat").data());
+                min_lon_ = atof(reader.Attribute("minlon").data());
+                max_lon_ = atof(reader.Attribute("maxlon").data());
+            } else if ( name == "node" ) {
+                osm_nodes.emplace_back();
+                osm_nodes.back().id = std::strtoll(reader.Attribute("id").data(), nullptr, 10);
+                osm_nodes.back().node.y = atof(reader.Attribute("lat").data());
+                osm_nodes.back().node.x = atof(reader.Attribute("lon").data());
+            } else if ( name == "way" ) {
+                in_way = true;
+                way_type = Road::Invalid;
+                way_refs.clear();
+            }
+        } else if ( reader.Depth() == 2 && in_way ) {
+            if ( name == "nd" ) {
+                way_refs.emplace_back(std::strtoll(reader.Attribute("ref").data(), nullptr, 10));
+            } else if( name == "tag" ) {
+                auto category = reader.Attribute("k");
+                auto type = reader.Attribute("v");
+                if ( category == "highway" )
+                    way_type = String2RoadType(type);
+            }
+        }
     }
 
-    std::unordered_map<std::string, int> way_id_to_num;    
-    for ( const auto &way: doc.select_nodes("/osm/way") ) {
-        auto node = way.node();
-        
+    if ( !has_bounds )
+        throw std::logic_error("map's bounds are not defined");
+
+    // OSM files list nodes by id already, so this rarely needs to sort
+    auto by_id = [](const OsmNode &_1st, const OsmNode &_2nd) { return _1st.id < _2nd.id; };
+    if ( !std::is_sorted(osm_nodes.begin(), osm_nodes.end(), by_id) )
+        std::sort(osm_nodes.begin(), osm_nodes.end(), by_id);
+
+    // Resolve road node refs, numbering nodes in the order roads first use them
+    std::vector<int> node_num(osm_nodes.size(), -1);
+    for ( std::size_t road = 0; road < road_types.size(); ++road ) {
         const auto way_num = (int)ways_.size();
-        way_id_to_num[node.attribute("id").as_string()] = way_num;
         ways_.emplace_back();
         auto &new_way = ways_.back();
-        
-        for ( auto child: node.children() ) {
-            auto name = std::string_view{child.name()}; 
-            if ( name == "nd" ) {
-                auto ref = child.attribute("ref").as_string();
-                if ( auto it = node_id_to_num.find(ref); it != end(node_id_to_num) )
-                    new_way.nodes.emplace_back(it->second);
-            } else if( name == "tag" ) {
-                auto category = std::string_view{child.attribute("k").as_string()};
-                auto type = std::string_view{child.attribute("v").as_string()};
-                if ( category == "highway" ) {
-                    if ( auto road_type = String2RoadType(type); road_type != Road::Invalid ) {
-                        roads_.emplace_back();
-                        roads_.back().way = way_num;
-                        roads_.back().type = road_type;
-                    }
-                }
+        for ( std::size_t i = road_ref_offsets[road]; i < road_ref_offsets[road + 1]; ++i ) {
+            auto it = std::lower_bound(osm_nodes.begin(), osm_nodes.end(), OsmNode{ road_refs[i], {} }, by_id);
+            if ( it == osm_nodes.end() || it->id != road_refs[i] )
+                continue;
+            auto &num = node_num[it - osm_nodes.begin()];
+            if ( num < 0 ) {
+                num = (int)nodes_.size();
+                nodes_.emplace_back(it->node);
             }
+            new_way.nodes.emplace_back(num);
         }
+        roads_.emplace_back();
+        roads_.back().way = way_num;
+        roads_.back().type = road_types[road];
     }
 }
 
@@ -9,13 +9,17 @@
 #ifndef MODEL_H_
 #define MODEL_H_
 
+#include <istream>
 #include <vector>
-#include <unordered_map>
 #include <string>
-#include <cstddef>
 
 #include "coordinate.h"
 
+// Avoid circular includes
+namespace rideshare {
+    class MapCache;
+}
+
 namespace rideshare {
 
 class Model {
@@ -36,8 +40,10 @@ class Model {
         Type type;
     };  
     
-    // Constructor
-    Model( const std::vector<std::byte> &xml );
+    // Constructors
+    Model( std::istream &osm_data );
+    // Takes the cache's node and road sections rather than copying them
+    Model( MapCache &cache );
     
     // Getters
     auto MetricScale() const noexcept { return metric_scale_; }    
@@ -54,8 +60,8 @@ class Model {
     Coordinate GetRandomMapPosition() const noexcept;
     
   private:
-    // Load OSM XML data file
-    void LoadData(const std::vector<std::byte> &xml);
+    // Load OSM XML data in a single streaming pass
+    void LoadData(std::istream &osm_data);
     
     std::vector<Node> nodes_;
     std::vector<Way> ways_;
@@ -0,0 +1,200 @@
+/**
+ * @file osm_reader.cpp
+ * @brief Implementation of streaming through OpenStreetMap XML elements with a bounded buffer.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "osm_reader.h"
+
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace rideshare {
+
+OsmReader::OsmReader(std::istream &input, std::size_t buffer_size) : input_(input), buffer_(buffer_size) {}
+
+std::string_view OsmReader::Attribute(std::string_view key) const {
+    for (const auto &[attribute_key, value] : attributes_) {
+        if (attribute_key == key) {
+            return value;
+        }
+    }
+    return "";
+}
+
+bool OsmReader::Next() {
+    // Finish off a self-closing element first
+    if (pending_end_) {
+        pending_end_ = false;
+        event_ = end_element;
+        attributes_.clear();
+        depth_ = --open_elements_;
+        return true;
+    }
+
+    while (true) {
+        // Skip any text until the next markup
+        const char *markup_start = static_cast<const char *>(std::memchr(buffer_.data() + begin_, '<', end_ - begin_));
+        if (markup_start == nullptr) {
+            begin_ = end_;
+            if (!Refill()) {
+                if (open_elements_ > 0) {
+                    throw std::logic_error("xml file ended inside of an element");
+                }
+                return false;
+            }
+            continue;
+        }
+        begin_ = markup_start - buffer_.data();
+
+        std::size_t markup_end;
+        if (!FindMarkupEnd(markup_end)) {
+            throw std::logic_error("xml file ended inside of a tag");
+        }
+        std::size_t markup_begin = begin_;
+        begin_ = markup_end;
+
+        // Skip comments, declarations and the like
+        char kind = buffer_[markup_begin + 1];
+        if (kind == '?' || kind == '!') {
+            continue;
+        }
+        ParseTag(markup_begin, markup_end);
+        return true;
+    }
+}
+
+bool OsmReader::FindMarkupEnd(std::size_t &markup_end) {
+    while (true) {
+        std::string_view data{buffer_.data() + begin_, end_ - begin_};
+        std::size_t close = std::string_view::npos;
+        if (data.substr(0, 4) == "<!--") {
+            close = data.find("-->", 4);
+            close = (close == std::string_view::npos) ? close : close + 3;
+        } else if (data.substr(0, 9) == "<![CDATA[") {
+            close = data.find("]]>", 9);
+            close = (close == std::string_view::npos) ? close : close + 3;
+        } else {
+            // A '>' inside a quoted attribute value does not end the tag
+            char quote = '\0';
+            for (std::size_t i = 1; i < data.size(); ++i) {
+                if (quote != '\0') {
+                    quote = (data[i] == quote) ? '\0' : quote;
+                } else if (data[i] == '"' || data[i] == '\'') {
+                    quote = data[i];
+                } else if (data[i] == '>') {
+                    close = i + 1;
+                    break;
+                }
+            }
+        }
+
+        if (close != std::string_view::npos) {
+            markup_end = begin_ + close;
+            return true;
+        }
+        if (!Refill()) {
+            return false;
+        }
+    }
+}
+
+bool OsmReader::Refill() {
+    // Keep any unread data, moving it to the front
+    if (begin_ > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    // Only grow if a single piece of markup fills the whole buffer
+    if (end_ == buffer_.size()) {
+        buffer_.resize(buffer_.size() * 2);
+    }
+    input_.read(buffer_.data() + end_, buffer_.size() - end_);
+    std::size_t read = input_.gcount();
+    end_ += read;
+    return read > 0;
+}
+
+void OsmReader::ParseTag(std::size_t begin, std::size_t end) {
+    char *tag = buffer_.data();
+    std::size_t last = end - 1; // position of the closing '>'
+    std::size_t pos = begin + 1;
+    auto skip_space = [&]() {
+        while (pos < last && std::isspace(static_cast<unsigned char>(tag[pos]))) {
+            ++pos;
+        }
+    };
+    auto is_name_end = [&](char c) {
+        return std::isspace(static_cast<unsigned char>(c)) || c == '/' || c == '>' || c == '=';
+    };
+
+    bool is_end_tag = tag[pos] == '/';
+    if (is_end_tag) {
+        ++pos;
+    }
+    std::size_t name_begin = pos;
+    while (pos < last && !is_name_end(tag[pos])) {
+        ++pos;
+    }
+    if (pos == name_begin) {
+        throw std::logic_error("xml tag is missing its name");
+    }
+    name_ = std::string_view{tag + name_begin, pos - name_begin};
+    attributes_.clear();
+
+    if (is_end_tag) {
+        if (open_elements_ == 0) {
+            throw std::logic_error("xml end tag without a matching start tag");
+        }
+        event_ = end_element;
+        depth_ = --open_elements_;
+        return;
+    }
+
+    // Read attributes until the end of the tag
+    while (true) {
+        skip_space();
+        if (pos >= last) {
+            break;
+        } else if (tag[pos] == '/') {
+            pending_end_ = true;
+            break;
+        }
+        std::size_t key_begin = pos;
+        while (pos < last && !is_name_end(tag[pos])) {
+            ++pos;
+        }
+        std::string_view key{tag + key_begin, pos - key_begin};
+        skip_space();
+        if (key.empty() || pos >= last || tag[pos] != '=') {
+            throw std::logic_error("xml attribute is missing its value");
+        }
+        ++pos;
+        skip_space();
+        char quote = tag[pos];
+        if (quote != '"' && quote != '\'') {
+            throw std::logic_error("xml attribute value is not quoted");
+        }
+        std::size_t value_begin = ++pos;
+        while (pos < last && tag[pos] != quote) {
+            ++pos;
+        }
+        if (pos >= last) {
+            throw std::logic_error("xml attribute value is not closed");
+        }
+        // Overwrite the closing quote so the value can be used as a C string
+        tag[pos] = '\0';
+        attributes_.emplace_back(key, std::string_view{tag + value_begin, pos - value_begin});
+        ++pos;
+    }
+
+    event_ = start_element;
+    depth_ = open_elements_++;
+}
+
+}  // namespace rideshare
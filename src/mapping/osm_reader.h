@@ -0,0 +1,72 @@
+/**
+ * @file osm_reader.h
+ * @brief Streaming, single-pass reader of the elements in an OpenStreetMap XML file.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef OSM_READER_H_
+#define OSM_READER_H_
+
+#include <cstddef>
+#include <istream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace rideshare {
+
+class OsmReader {
+  public:
+    enum EventType {
+        start_element,
+        end_element,
+    };
+
+    // Constructors / Destructors
+    // Reads from input in chunks, so memory use is bounded by the buffer and the longest tag
+    OsmReader(std::istream &input, std::size_t buffer_size = DEFAULT_BUFFER_SIZE_);
+
+    // Primary functionality
+    // Move to the next start or end of an element, skipping text, comments and declarations.
+    //  Returns false at the end of input, and throws std::logic_error on malformed XML.
+    //  Self-closing elements give a start event followed by an end event.
+    bool Next();
+
+    // Getters
+    // Details of the current event; views are only valid until the next call to Next()
+    EventType Event() const { return event_; }
+    std::string_view Name() const { return name_; }
+    // Depth of the current element, with the root element at 0
+    int Depth() const { return depth_; }
+    // Value of an attribute of the current start element (null-terminated), or empty if not present
+    std::string_view Attribute(std::string_view key) const;
+
+  private:
+    // Find where the markup starting at begin_ ends (one past its closing '>'), reading more input
+    //  as needed; returns false if input ends first. May move the unread data within buffer_.
+    bool FindMarkupEnd(std::size_t &markup_end);
+    // Move unread data to the front of the buffer (growing it if full) and read more input
+    bool Refill();
+    // Parse a start or end tag within [begin, end) of the buffer
+    void ParseTag(std::size_t begin, std::size_t end);
+
+    static constexpr std::size_t DEFAULT_BUFFER_SIZE_ = 1 << 16;
+
+    std::istream &input_;
+    std::vector<char> buffer_;
+    std::size_t begin_ = 0; // start of unread data in buffer_
+    std::size_t end_ = 0;   // end of valid data in buffer_
+
+    EventType event_ = end_element;
+    std::string_view name_;
+    std::vector<std::pair<std::string_view, std::string_view>> attributes_;
+    int depth_ = -1;
+    int open_elements_ = 0; // elements started but not yet ended
+    bool pending_end_ = false; // a self-closing element still needs its end event
+};
+
+}  // namespace rideshare
+
+#endif  // OSM_READER_H_
@@ -1,6 +1,6 @@
 /**
  * @file route_model.cpp
- * @brief Implementation for finding map node neighbors and closest nodes to a point.
+ * @brief Implementation for building the road graph and finding closest nodes to a point.
  *
  * @cite Adapted from https://github.com/udacity/CppND-Route-Planning-Project
  *
@@ -8,80 +8,185 @@
 
 #include "route_model.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "map_cache.h"
 
 namespace rideshare {
 
-RouteModel::RouteModel(const std::vector<std::byte> &xml) : Model(xml) {
+RouteModel::RouteModel(std::istream &osm_data) : Model(osm_data) {
+    CreateNodes();
+    BuildRoadGraph();
+    BuildComponents();
+    BuildNodeGrid();
+    BuildPositionSampler();
+}
+
+
+RouteModel::RouteModel(MapCache &cache) : Model(cache) {
+    CreateNodes();
+    // Road graph comes straight from the cache
+    edge_offsets_ = std::move(cache.EdgeOffsets());
+    edge_targets_ = std::move(cache.EdgeTargets());
+    edge_lengths_ = std::move(cache.EdgeLengths());
+    BuildComponents();
+    BuildNodeGrid();
+    BuildPositionSampler();
+}
+
+
+void RouteModel::CreateNodes() {
     // Create RouteModel nodes.
     int counter = 0;
     for (Model::Node node : this->Nodes()) {
-        nodes_.emplace_back(Node(counter, this, node));
-        clean_nodes_.emplace_back(Node(counter, this, node));
+        nodes_.emplace_back(Node(counter, node));
         counter++;
     }
-    CreateNodeToRoadHashmap();
 }
 
 
-void RouteModel::CreateNodeToRoadHashmap() {
+void RouteModel::BuildRoadGraph() {
+    // Gather both directions of each road segment, as directions of streets are ignored
+    std::vector<std::pair<int, int>> edges;
     for (const Model::Road &road : Roads()) {
-        for (int node_idx : Ways()[road.way].nodes) {
-            if (node_to_road_.find(node_idx) == node_to_road_.end()) {
-                node_to_road_[node_idx] = std::vector<const Model::Road *> ();
+        const std::vector<int> &way_nodes = Ways()[road.way].nodes;
+        for (std::size_t i = 1; i < way_nodes.size(); ++i) {
+            if (way_nodes[i - 1] != way_nodes[i]) {
+                edges.emplace_back(way_nodes[i - 1], way_nodes[i]);
+                edges.emplace_back(way_nodes[i], way_nodes[i - 1]);
             }
-            node_to_road_[node_idx].push_back(&road);
         }
     }
+    // Group edges by starting node, dropping duplicates from roads sharing segments
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    edge_offsets_.assign(nodes_.size() + 1, 0);
+    edge_targets_.reserve(edges.size());
+    edge_lengths_.reserve(edges.size());
+    for (const auto &[from, to] : edges) {
+        ++edge_offsets_[from + 1];
+        edge_targets_.emplace_back(to);
+        edge_lengths_.emplace_back(nodes_[from].Distance(nodes_[to]));
+    }
+    // Turn edge counts into offsets
+    for (std::size_t i = 1; i < edge_offsets_.size(); ++i) {
+        edge_offsets_[i] += edge_offsets_[i - 1];
+    }
 }
 
 
-RouteModel::Node *RouteModel::Node::FindNeighbor(std::vector<int> node_indices) {
-    Node *closest_node = nullptr;
-    Node node;
-
-    for (int node_index : node_indices) {
-        node = parent_model->SNodes()[node_index];
-        if (this->Distance(node) != 0 && !node.visited_) {
-            if (closest_node == nullptr || this->Distance(node) < this->Distance(*closest_node)) {
-                closest_node = &parent_model->SNodes()[node_index];
+void RouteModel::BuildComponents() {
+    // Every road segment is an edge in both directions, so connected components are also strongly connected
+    const int UNLABELED = -1;
+    components_.assign(nodes_.size(), UNLABELED);
+    std::vector<int> component_sizes;
+    std::vector<int> to_visit;
+    for (int start = 0; start < (int)nodes_.size(); ++start) {
+        if (components_[start] != UNLABELED) {
+            continue;
+        }
+        // Flood fill along road graph edges from an unlabeled node
+        int label = component_sizes.size();
+        int size = 0;
+        components_[start] = label;
+        to_visit.emplace_back(start);
+        while (!to_visit.empty()) {
+            int node_idx = to_visit.back();
+            to_visit.pop_back();
+            ++size;
+            for (int edge = edge_offsets_[node_idx]; edge < edge_offsets_[node_idx + 1]; ++edge) {
+                int neighbor_idx = edge_targets_[edge];
+                if (components_[neighbor_idx] == UNLABELED) {
+                    components_[neighbor_idx] = label;
+                    to_visit.emplace_back(neighbor_idx);
+                }
             }
         }
+        component_sizes.emplace_back(size);
+    }
+    if (!component_sizes.empty()) {
+        main_component_ = std::max_element(component_sizes.begin(), component_sizes.end()) - component_sizes.begin();
     }
-    return closest_node;
 }
 
 
-void RouteModel::Node::FindNeighbors() {
-    for (auto & road : parent_model->node_to_road_[this->index_]) {
-        RouteModel::Node *new_neighbor = this->FindNeighbor(parent_model->Ways()[road->way].nodes);
-        if (new_neighbor) {
-            this->neighbors_.emplace_back(new_neighbor);
+void RouteModel::BuildNodeGrid() {
+    // Road nodes are those with at least one road graph edge; only those in the main component are used,
+    //  so any two positions snap to nodes with a route between them
+    std::vector<int> road_nodes;
+    double min_x = std::numeric_limits<double>::max();
+    double min_y = std::numeric_limits<double>::max();
+    double max_x = std::numeric_limits<double>::lowest();
+    double max_y = std::numeric_limits<double>::lowest();
+    for (const Node &node : nodes_) {
+        if (components_[node.Index()] == main_component_ && edge_offsets_[node.Index() + 1] > edge_offsets_[node.Index()]) {
+            road_nodes.emplace_back(node.Index());
+            min_x = std::min(min_x, node.x);
+            min_y = std::min(min_y, node.y);
+            max_x = std::max(max_x, node.x);
+            max_y = std::max(max_y, node.y);
         }
     }
-}
-
+    if (road_nodes.empty()) {
+        throw std::logic_error("map has no road nodes");
+    }
 
-RouteModel::Node &RouteModel::FindClosestNode(const Coordinate &coordinate) {
-    Node input;
-    input.x = coordinate.x;
-    input.y = coordinate.y;
+    // Size cells to hold a handful of road nodes each, on average
+    const double NODES_PER_CELL = 4.0;
+    double area = std::max((max_x - min_x) * (max_y - min_y), std::numeric_limits<double>::min());
+    double cell_size = std::sqrt(area * NODES_PER_CELL / road_nodes.size());
+    node_grid_ = SpatialGrid(min_x, min_y, max_x, max_y, cell_size);
+    for (int node_idx : road_nodes) {
+        node_grid_.Insert(node_idx, (Coordinate){ .x = nodes_[node_idx].x, .y = nodes_[node_idx].y });
+    }
+}
 
-    float min_dist = std::numeric_limits<float>::max();
-    float dist;
-    int closest_idx;
 
-    for (const Model::Road &road : Roads()) {
-        for (int node_idx : Ways()[road.way].nodes) {
-            dist = input.Distance(SNodes()[node_idx]);
-            if (dist < min_dist) {
-                closest_idx = node_idx;
-                min_dist = dist;
+void RouteModel::BuildPositionSampler() {
+    // Each road segment is stored as an edge in both directions, so only take one of them
+    std::vector<double> lengths;
+    for (int from = 0; from < (int)nodes_.size(); ++from) {
+        if (components_[from] != main_component_) {
+            continue;
+        }
+        for (int edge = edge_offsets_[from]; edge < edge_offsets_[from + 1]; ++edge) {
+            if (from < edge_targets_[edge]) {
+                sampled_segments_.emplace_back(from, edge_targets_[edge]);
+                lengths.emplace_back(edge_lengths_[edge]);
             }
         }
     }
+    segment_sampler_ = AliasTable(lengths);
+}
+
+
+Coordinate RouteModel::GetRandomMapPosition() const noexcept {
+    if (segment_sampler_.Empty()) {
+        return Model::GetRandomMapPosition();
+    }
+    // Pick a road segment, then a point along it
+    const double RANGE = (double) RAND_MAX + 1.0; // keeps values below 1
+    double pick = rand() / RANGE;
+    double coin = rand() / RANGE;
+    double along = (double) rand() / RAND_MAX;
+    const auto &[from, to] = sampled_segments_[segment_sampler_.Sample(pick, coin)];
+    const Node &start = nodes_[from];
+    const Node &end = nodes_[to];
+    return (Coordinate){ .x = start.x + ((end.x - start.x) * along),
+                         .y = start.y + ((end.y - start.y) * along) };
+}
+
 
-    return SNodes()[closest_idx];
+const RouteModel::Node &RouteModel::FindClosestNode(const Coordinate &coordinate) const {
+    // Only road nodes of the main component are in the grid, which is never empty (see BuildNodeGrid)
+    return nodes_[node_grid_.Nearest(coordinate)];
 }
 
 }  // namespace rideshare
@@ -12,10 +12,13 @@
 #include <cmath>
 #include <limits>
 #include <iostream>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "alias_table.h"
 #include "coordinate.h"
 #include "model.h"
+#include "spatial_grid.h"
 
 namespace rideshare {
 
@@ -24,45 +27,62 @@ class RouteModel : public Model {
   public:
     class Node : public Model::Node {
       public:
-        Node * parent_ = nullptr;
-        float h_value_ = std::numeric_limits<float>::max();
-        float g_value_ = 0.0;
-        bool visited_ = false;
-        std::vector<Node *> neighbors_;
-
-        // Find neighbors of nodes
-        void FindNeighbors();
         // Find distance between two nodes
-        float Distance(Node other) const {
+        float Distance(const Node &other) const {
             return std::sqrt(std::pow((x - other.x), 2) + std::pow((y - other.y), 2));
         }
+        // Index of the node within the model
+        int Index() const { return index_; }
 
         // Constructors
         Node(){}
-        Node(int idx, RouteModel * search_model, Model::Node node) : Model::Node(node), parent_model(search_model), index_(idx) {}
+        Node(int idx, Model::Node node) : Model::Node(node), index_(idx) {}
 
       private:
-        int index_;
-        // Find neighbor of given node
-        Node * FindNeighbor(std::vector<int> node_indices);
-        RouteModel * parent_model = nullptr;
+        int index_ = -1;
     };
 
-    // Constructor
-    RouteModel(const std::vector<std::byte> &xml);
-    // Getter
-    auto &SNodes() { return nodes_; }
-    // Find closest road node to a coordinate
-    Node &FindClosestNode(const Coordinate &coordinate);
-    // Reset all nodes so can be re-used by route planner
-    void ResetNodes() { nodes_ = clean_nodes_; }
+    // Constructors (throw std::logic_error if the map has no road nodes to snap positions to)
+    RouteModel(std::istream &osm_data);
+    // Load an already processed road graph, skipping any OSM parsing
+    //  (takes the cache's sections rather than copying them)
+    RouteModel(MapCache &cache);
+    // Getters
+    auto &SNodes() const { return nodes_; }
+    // Road graph edges in compressed sparse row form; edges leaving node i are those
+    //  from EdgeOffsets()[i] up to (not including) EdgeOffsets()[i + 1]
+    auto &EdgeOffsets() const { return edge_offsets_; }
+    auto &EdgeTargets() const { return edge_targets_; }
+    auto &EdgeLengths() const { return edge_lengths_; }
+    // Connected component label of each node; a route exists between two nodes only if their labels match
+    int Component(int node_idx) const { return components_[node_idx]; }
+    bool Connected(int node_idx, int other_idx) const { return components_[node_idx] == components_[other_idx]; }
+    // Return a random position along a road of the main component, with longer roads more likely
+    //  (in place of the bounding box version in Model, which is only used if there are no roads)
+    Coordinate GetRandomMapPosition() const noexcept;
+    // Find closest road node to a coordinate (only nodes in the largest connected component are considered)
+    const Node &FindClosestNode(const Coordinate &coordinate) const;
     
   private:
-    // Map nodes to given roads on the map
-    void CreateNodeToRoadHashmap();
-    std::unordered_map<int, std::vector<const Model::Road *>> node_to_road_;
+    // Create RouteModel nodes from the Model nodes
+    void CreateNodes();
+    // Connect each node to the nodes before and after it along every road
+    void BuildRoadGraph();
+    // Label each node with its connected component in the road graph, and find the largest
+    void BuildComponents();
+    // Bucket road nodes of the largest component into a grid for fast closest node lookups
+    void BuildNodeGrid();
+    // Weight each road segment of the largest component by its length, for random positions
+    void BuildPositionSampler();
     std::vector<Node> nodes_;
-    std::vector<Node> clean_nodes_;
+    std::vector<int> edge_offsets_; // size of nodes_ + 1
+    std::vector<int> edge_targets_; // index of node at the other end of each edge
+    std::vector<float> edge_lengths_; // distance between the nodes of each edge
+    std::vector<int> components_; // component label of each node
+    int main_component_ = -1; // label of the component with the most nodes
+    SpatialGrid node_grid_; // road nodes of the main component only
+    std::vector<std::pair<int, int>> sampled_segments_; // node indices at each end of main component road segments
+    AliasTable segment_sampler_; // picks from sampled_segments_ by length
 
 };
 
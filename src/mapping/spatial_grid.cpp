@@ -0,0 +1,76 @@
+/**
+ * @file spatial_grid.cpp
+ * @brief Implementation of a uniform grid for nearest-position lookups.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace rideshare {
+
+SpatialGrid::SpatialGrid(double min_x, double min_y, double max_x, double max_y, double cell_size) :
+  min_x_(min_x), min_y_(min_y), cell_size_(cell_size) {
+    columns_ = std::max(1, (int)std::ceil((max_x - min_x) / cell_size));
+    rows_ = std::max(1, (int)std::ceil((max_y - min_y) / cell_size));
+    cells_.resize(columns_ * rows_);
+}
+
+int SpatialGrid::Column(double x) const {
+    return std::clamp((int)std::floor((x - min_x_) / cell_size_), 0, columns_ - 1);
+}
+
+int SpatialGrid::Row(double y) const {
+    return std::clamp((int)std::floor((y - min_y_) / cell_size_), 0, rows_ - 1);
+}
+
+void SpatialGrid::Insert(int id, const Coordinate &position) {
+    int cell = Cell(position);
+    cells_[cell].emplace_back((Item){ .id = id, .position = position });
+    ++size_;
+}
+
+int SpatialGrid::Nearest(const Coordinate &position) const {
+    int center_column = Column(position.x);
+    int center_row = Row(position.y);
+    int nearest = NONE;
+    double nearest_dist_sq = std::numeric_limits<double>::max();
+    int max_ring = std::max(columns_, rows_);
+
+    // Search rings of cells outward from the cell holding the position
+    for (int ring = 0; ring <= max_ring; ++ring) {
+        // Anything in this ring or beyond is at least (ring - 1) cells away, so stop if already closer
+        double ring_min_dist = (ring - 1) * cell_size_;
+        if (nearest != NONE && ring_min_dist > 0 && nearest_dist_sq <= ring_min_dist * ring_min_dist) {
+            break;
+        }
+        for (int row = center_row - ring; row <= center_row + ring; ++row) {
+            if (row < 0 || row >= rows_) {
+                continue;
+            }
+            // Rows at the edge of the ring cover every column, otherwise only the two sides
+            bool edge_row = (row == center_row - ring) || (row == center_row + ring);
+            int column_step = (edge_row || ring == 0) ? 1 : 2 * ring;
+            for (int column = center_column - ring; column <= center_column + ring; column += column_step) {
+                if (column < 0 || column >= columns_) {
+                    continue;
+                }
+                for (const Item &item : cells_[(row * columns_) + column]) {
+                    double dist_sq = std::pow(item.position.x - position.x, 2) + std::pow(item.position.y - position.y, 2);
+                    if (dist_sq < nearest_dist_sq) {
+                        nearest = item.id;
+                        nearest_dist_sq = dist_sq;
+                    }
+                }
+            }
+        }
+    }
+    return nearest;
+}
+
+}  // namespace rideshare
@@ -0,0 +1,58 @@
+/**
+ * @file spatial_grid.h
+ * @brief Uniform grid of ids bucketed by position, for finding the nearest one to a point.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef SPATIAL_GRID_H_
+#define SPATIAL_GRID_H_
+
+#include <vector>
+
+#include "coordinate.h"
+
+namespace rideshare {
+
+class SpatialGrid {
+  public:
+    static constexpr int NONE = -1;
+
+    // Constructors / Destructors
+    SpatialGrid() {};
+    // Cover the given bounds with square cells; positions outside the bounds go in the nearest edge cell
+    SpatialGrid(double min_x, double min_y, double max_x, double max_y, double cell_size);
+
+    // Getters / Setters
+    bool Empty() const { return size_ == 0; }
+
+    // Primary functionality
+    // Add an id at the given position
+    void Insert(int id, const Coordinate &position);
+    // Find the id nearest to a position, or NONE if the grid is empty
+    int Nearest(const Coordinate &position) const;
+
+  private:
+    struct Item {
+        int id;
+        Coordinate position;
+    };
+
+    // Cell column / row holding a position, clamped onto the grid
+    int Column(double x) const;
+    int Row(double y) const;
+    int Cell(const Coordinate &position) const { return (Row(position.y) * columns_) + Column(position.x); }
+
+    double min_x_ = 0.;
+    double min_y_ = 0.;
+    double cell_size_ = 1.;
+    int columns_ = 0;
+    int rows_ = 0;
+    int size_ = 0;
+    std::vector<std::vector<Item>> cells_; // row-major
+};
+
+}  // namespace rideshare
+
+#endif  // SPATIAL_GRID_H_
@@ -0,0 +1,93 @@
+/**
+ * @file assignment_solver.cpp
+ * @brief Implementation of the Hungarian algorithm with potentials, O(rows^2 * cols).
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "assignment_solver.h"
+
+#include <limits>
+
+namespace rideshare {
+
+void AssignmentSolver::Solve(const std::vector<double> &costs, int rows, int cols, std::vector<int> &row_to_col) {
+    row_to_col.assign(rows, UNASSIGNED);
+    if (rows == 0 || cols == 0) {
+        return;
+    }
+    if (rows <= cols) {
+        SolveWide(rows, cols, [&](int row, int col) { return costs[(row * cols) + col]; }, row_to_col);
+        return;
+    }
+    // More rows than columns, so solve the transposed matrix and flip the result back
+    std::vector<int> col_to_row;
+    col_to_row.assign(cols, UNASSIGNED);
+    SolveWide(cols, rows, [&](int col, int row) { return costs[(row * cols) + col]; }, col_to_row);
+    for (int col = 0; col < cols; ++col) {
+        row_to_col[col_to_row[col]] = col;
+    }
+}
+
+template <typename CostFn>
+void AssignmentSolver::SolveWide(int rows, int cols, CostFn cost, std::vector<int> &row_to_col) {
+    const double INF = std::numeric_limits<double>::max();
+    // Arrays below are 1-indexed, with column 0 a virtual column used to start each augmentation
+    row_potentials_.assign(rows + 1, 0.0);
+    col_potentials_.assign(cols + 1, 0.0);
+    col_to_row_.assign(cols + 1, 0);
+    way_.assign(cols + 1, 0);
+
+    for (int row = 1; row <= rows; ++row) {
+        // Find a shortest augmenting path for this row through the reduced costs
+        col_to_row_[0] = row;
+        int col0 = 0;
+        min_slack_.assign(cols + 1, INF);
+        used_.assign(cols + 1, false);
+        do {
+            used_[col0] = true;
+            int row0 = col_to_row_[col0];
+            double delta = INF;
+            int col1 = 0;
+            for (int col = 1; col <= cols; ++col) {
+                if (used_[col]) {
+                    continue;
+                }
+                double reduced = cost(row0 - 1, col - 1) - row_potentials_[row0] - col_potentials_[col];
+                if (reduced < min_slack_[col]) {
+                    min_slack_[col] = reduced;
+                    way_[col] = col0;
+                }
+                if (min_slack_[col] < delta) {
+                    delta = min_slack_[col];
+                    col1 = col;
+                }
+            }
+            for (int col = 0; col <= cols; ++col) {
+                if (used_[col]) {
+                    row_potentials_[col_to_row_[col]] += delta;
+                    col_potentials_[col] -= delta;
+                } else {
+                    min_slack_[col] -= delta;
+                }
+            }
+            col0 = col1;
+        } while (col_to_row_[col0] != 0);
+
+        // Flip the assignments along the augmenting path
+        do {
+            int col1 = way_[col0];
+            col_to_row_[col0] = col_to_row_[col1];
+            col0 = col1;
+        } while (col0 != 0);
+    }
+
+    for (int col = 1; col <= cols; ++col) {
+        if (col_to_row_[col] != 0) {
+            row_to_col[col_to_row_[col] - 1] = col - 1;
+        }
+    }
+}
+
+}  // namespace rideshare
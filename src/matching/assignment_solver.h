@@ -0,0 +1,42 @@
+/**
+ * @file assignment_solver.h
+ * @brief Minimum total cost assignment of rows to columns of a cost matrix (Hungarian algorithm).
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef ASSIGNMENT_SOLVER_H_
+#define ASSIGNMENT_SOLVER_H_
+
+#include <vector>
+
+namespace rideshare {
+
+class AssignmentSolver {
+  public:
+    static constexpr int UNASSIGNED = -1;
+
+    // Primary functionality
+    // Assign rows to columns of a row-major cost matrix so the total cost is lowest, with each
+    //  row and column used at most once. Fills row_to_col with the column of each row, or
+    //  UNASSIGNED for leftover rows when there are more rows than columns.
+    void Solve(const std::vector<double> &costs, int rows, int cols, std::vector<int> &row_to_col);
+
+  private:
+    // Solve with rows <= cols, where cost(row, col) reads from the matrix (possibly transposed)
+    template <typename CostFn>
+    void SolveWide(int rows, int cols, CostFn cost, std::vector<int> &row_to_col);
+
+    // Work space kept between calls to avoid re-allocating each time
+    std::vector<double> row_potentials_;
+    std::vector<double> col_potentials_;
+    std::vector<double> min_slack_;
+    std::vector<int> col_to_row_;
+    std::vector<int> way_;
+    std::vector<char> used_;
+};
+
+}  // namespace rideshare
+
+#endif  // ASSIGNMENT_SOLVER_H_
@@ -0,0 +1,458 @@
+/**
+ * @file contraction_hierarchy.cpp
+ * @brief Implementation of contracting the road graph, querying it and reading/writing it to disk.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "contraction_hierarchy.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace rideshare {
+
+static const char MAGIC[8] = {'R', 'S', 'C', 'H', 'B', 'I', 'N', '\0'};
+
+// Witness searches give up after settling this many nodes, adding a (possibly unneeded) shortcut instead
+static const int WITNESS_SETTLE_LIMIT = 500;
+
+// Graph of the nodes not yet contracted, with shortcuts added as contraction goes on
+struct ContractionGraph {
+    ContractionGraph(int node_count) : incident(node_count), contracted(node_count, false),
+                                       contracted_neighbors(node_count, 0), witness(node_count) {}
+
+    std::vector<std::vector<int>> incident; // edge indices touching each node, possibly to contracted nodes
+    std::vector<char> contracted;
+    std::vector<int> contracted_neighbors; // spreads contraction evenly across the map
+    SearchScratch witness; // distances of the current witness search
+    std::vector<std::pair<int, int>> neighbors; // (neighbor, edge) of the node being contracted
+};
+
+// Gather the lowest weight edge to each neighbor not yet contracted
+template <typename EdgeList>
+static void FindNeighbors(ContractionGraph &graph, const EdgeList &edges, int node) {
+    graph.neighbors.clear();
+    for (int edge : graph.incident[node]) {
+        int neighbor = (edges[edge].a == node) ? edges[edge].b : edges[edge].a;
+        if (!graph.contracted[neighbor] && neighbor != node) {
+            graph.neighbors.emplace_back(neighbor, edge);
+        }
+    }
+    std::sort(graph.neighbors.begin(), graph.neighbors.end(), [&edges](const auto &lhs, const auto &rhs) {
+        return (lhs.first != rhs.first) ? lhs.first < rhs.first : edges[lhs.second].weight < edges[rhs.second].weight;
+    });
+    graph.neighbors.erase(std::unique(graph.neighbors.begin(), graph.neighbors.end(),
+                                      [](const auto &lhs, const auto &rhs) { return lhs.first == rhs.first; }),
+                          graph.neighbors.end());
+}
+
+// Bounded Dijkstra from source, skipping the node being contracted, to see which neighbors are
+//  already reachable without it
+template <typename EdgeList>
+static void WitnessSearch(ContractionGraph &graph, const EdgeList &edges, int source, int skipped, float max_distance) {
+    graph.witness.NewSearch();
+    int settled = 0;
+    graph.witness.Dijkstra(source, [&graph, &edges, skipped](int node, auto relax) {
+        for (int edge : graph.incident[node]) {
+            int next = (edges[edge].a == node) ? edges[edge].b : edges[edge].a;
+            if (next != skipped && !graph.contracted[next]) {
+                relax(next, edges[edge].weight);
+            }
+        }
+    }, [&settled, max_distance](int, float distance) {
+        return distance <= max_distance && settled++ < WITNESS_SETTLE_LIMIT;
+    });
+}
+
+// Call add_shortcut(first, second) for each pair of neighbor list positions needing a shortcut through node
+template <typename EdgeList>
+static void FindShortcuts(ContractionGraph &graph, const EdgeList &edges, int node,
+                          const std::function<void(int, int)> &add_shortcut) {
+    const auto &neighbors = graph.neighbors;
+    for (std::size_t first = 0; first + 1 < neighbors.size(); ++first) {
+        float to_first = edges[neighbors[first].second].weight;
+        float max_distance = 0.0;
+        for (std::size_t second = first + 1; second < neighbors.size(); ++second) {
+            max_distance = std::max(max_distance, to_first + edges[neighbors[second].second].weight);
+        }
+        WitnessSearch(graph, edges, neighbors[first].first, node, max_distance);
+        for (std::size_t second = first + 1; second < neighbors.size(); ++second) {
+            int target = neighbors[second].first;
+            float via_node = to_first + edges[neighbors[second].second].weight;
+            if (!graph.witness.Seen(target) || graph.witness.State(target).g_value > via_node) {
+                add_shortcut(first, second);
+            }
+        }
+    }
+}
+
+ContractionHierarchy::ContractionHierarchy(const RouteModel &model) : fingerprint_(Fingerprint(model)) {
+    Contract(model);
+}
+
+std::uint64_t ContractionHierarchy::Fingerprint(const RouteModel &model) {
+    // FNV-1a over the raw road graph arrays
+    std::uint64_t hash = 14695981039346656037ull;
+    auto add_bytes = [&hash](const void *data, std::size_t bytes) {
+        const unsigned char *bytes_ptr = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < bytes; ++i) {
+            hash = (hash ^ bytes_ptr[i]) * 1099511628211ull;
+        }
+    };
+    add_bytes(model.EdgeOffsets().data(), model.EdgeOffsets().size() * sizeof(int));
+    add_bytes(model.EdgeTargets().data(), model.EdgeTargets().size() * sizeof(int));
+    add_bytes(model.EdgeLengths().data(), model.EdgeLengths().size() * sizeof(float));
+    return hash;
+}
+
+void ContractionHierarchy::Contract(const RouteModel &model) {
+    int node_count = model.SNodes().size();
+    ContractionGraph graph(node_count);
+
+    // Start with one edge per road segment (the model holds each in both directions)
+    for (int from = 0; from < node_count; ++from) {
+        for (int edge = model.EdgeOffsets()[from]; edge < model.EdgeOffsets()[from + 1]; ++edge) {
+            int to = model.EdgeTargets()[edge];
+            if (from < to) {
+                graph.incident[from].emplace_back(edges_.size());
+                graph.incident[to].emplace_back(edges_.size());
+                edges_.push_back({ from, to, model.EdgeLengths()[edge], NONE, NONE, NONE });
+            }
+        }
+    }
+    road_edge_count_ = edges_.size();
+
+    // Contract nodes adding the fewest edges (shortcuts added less edges removed, weighted double) first,
+    //  preferring those with fewer neighbors already contracted so contraction spreads evenly
+    auto priority = [&](int node) {
+        FindNeighbors(graph, edges_, node);
+        int shortcuts = 0;
+        FindShortcuts(graph, edges_, node, [&shortcuts](int, int) { ++shortcuts; });
+        return 2 * (shortcuts - (int)graph.neighbors.size()) + graph.contracted_neighbors[node];
+    };
+    using Entry = std::pair<int, int>; // priority, node
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> order;
+    for (int node = 0; node < node_count; ++node) {
+        order.emplace(priority(node), node);
+    }
+
+    std::vector<std::vector<int>> upward(node_count);
+    while (!order.empty()) {
+        int node = order.top().second;
+        order.pop();
+        if (graph.contracted[node]) {
+            continue;
+        }
+        // Priorities go stale as neighbors are contracted, so re-check before contracting (lazy updates)
+        int current = priority(node);
+        if (!order.empty() && current > order.top().first) {
+            order.emplace(current, node);
+            continue;
+        }
+
+        // Add the shortcuts, with the node as their middle
+        FindNeighbors(graph, edges_, node);
+        FindShortcuts(graph, edges_, node, [&](int first, int second) {
+            const auto &[a, edge_a] = graph.neighbors[first];
+            const auto &[b, edge_b] = graph.neighbors[second];
+            graph.incident[a].emplace_back(edges_.size());
+            graph.incident[b].emplace_back(edges_.size());
+            edges_.push_back({ a, b, edges_[edge_a].weight + edges_[edge_b].weight, node, edge_a, edge_b });
+        });
+
+        // All remaining neighbors are contracted later, so these are the node's upward edges
+        graph.contracted[node] = true;
+        for (const auto &[neighbor, edge] : graph.neighbors) {
+            upward[node].emplace_back(edge);
+            ++graph.contracted_neighbors[neighbor];
+            // Drop edges to contracted nodes, keeping later neighbor lists and witness searches short
+            std::vector<int> &incident = graph.incident[neighbor];
+            incident.erase(std::remove_if(incident.begin(), incident.end(), [&](int other_edge) {
+                return graph.contracted[Other(edges_[other_edge], neighbor)];
+            }), incident.end());
+        }
+        std::vector<int>().swap(graph.incident[node]);
+    }
+
+    // Flatten the upward edges for queries
+    upward_offsets_.assign(1, 0);
+    for (int node = 0; node < node_count; ++node) {
+        for (int edge : upward[node]) {
+            upward_targets_.emplace_back(Other(edges_[edge], node));
+            upward_weights_.emplace_back(edges_[edge].weight);
+            upward_edges_.emplace_back(edge);
+        }
+        upward_offsets_.emplace_back(upward_edges_.size());
+    }
+}
+
+void ContractionHierarchy::SearchStep(SearchScratch &side, SearchScratch &other, float &best, int &meet) const {
+    int node;
+    UpwardStep(side, node);
+    // Both searches reaching the same node gives a path, though not necessarily the shortest
+    float distance = side.State(node).g_value;
+    if (other.Seen(node) && distance + other.State(node).g_value < best) {
+        best = distance + other.State(node).g_value;
+        meet = node;
+    }
+}
+
+bool ContractionHierarchy::UpwardStep(SearchScratch &side, int &node) const {
+    node = side.OpenList().Pop();
+    SearchScratch::NodeState &state = side.State(node);
+    state.closed = true;
+    // Stall-on-demand: a later contracted neighbor reached this node more cheaply going down an edge,
+    //  so the shortest path doesn't go up from here
+    for (int edge = upward_offsets_[node]; edge < upward_offsets_[node + 1]; ++edge) {
+        int next = upward_targets_[edge];
+        if (side.Seen(next) && side.State(next).g_value + upward_weights_[edge] < state.g_value) {
+            return false;
+        }
+    }
+    // Relax upward edges only
+    for (int edge = upward_offsets_[node]; edge < upward_offsets_[node + 1]; ++edge) {
+        int next = upward_targets_[edge];
+        float distance = state.g_value + upward_weights_[edge];
+        if (!side.Seen(next)) {
+            SearchScratch::NodeState &next_state = side.State(next);
+            next_state.g_value = distance;
+            next_state.parent = upward_edges_[edge];
+            side.OpenList().Push(next, distance);
+        } else if (!side.Closed(next) && distance < side.State(next).g_value) {
+            SearchScratch::NodeState &next_state = side.State(next);
+            next_state.g_value = distance;
+            next_state.parent = upward_edges_[edge];
+            side.OpenList().DecreaseKey(next, distance);
+        }
+    }
+    return true;
+}
+
+void ContractionHierarchy::Query(int start_idx, int end_idx, SearchScratch &forward, SearchScratch &backward,
+                                 std::vector<int> &path) const {
+    path.clear();
+    // Node states hold the distance from that direction's start, and the edge reaching the node as parent
+    forward.NewSearch();
+    backward.NewSearch();
+    forward.State(start_idx).g_value = 0.0;
+    forward.OpenList().Push(start_idx, 0.0);
+    backward.State(end_idx).g_value = 0.0;
+    backward.OpenList().Push(end_idx, 0.0);
+
+    // Alternate by lowest distance, until neither direction can improve on the best meeting node
+    float best = std::numeric_limits<float>::max();
+    int meet = NONE;
+    while (true) {
+        bool forward_open = !forward.OpenList().Empty() && forward.OpenList().TopKey() < best;
+        bool backward_open = !backward.OpenList().Empty() && backward.OpenList().TopKey() < best;
+        if (!forward_open && !backward_open) {
+            break;
+        }
+        if (forward_open && (!backward_open || forward.OpenList().TopKey() <= backward.OpenList().TopKey())) {
+            SearchStep(forward, backward, best, meet);
+        } else {
+            SearchStep(backward, forward, best, meet);
+        }
+    }
+    if (meet == NONE) {
+        return;
+    }
+
+    // Unpack shortcuts going up from the start to the meeting node, then down to the end
+    path.emplace_back(start_idx);
+    UnpackForward(forward, meet, path);
+    for (int node = meet; backward.State(node).parent != SearchScratch::NO_PARENT;) {
+        int edge = backward.State(node).parent;
+        UnpackEdge(edge, node, path);
+        node = Other(edges_[edge], node);
+    }
+}
+
+void ContractionHierarchy::DistanceTable(const std::vector<int> &sources, const std::vector<int> &targets,
+                                         SearchScratch &search, SearchScratch &bucket_index,
+                                         std::vector<float> &table) const {
+    table.assign(sources.size() * targets.size(), std::numeric_limits<float>::max());
+
+    // Search up from each target, leaving its distance at every node settled without stalling
+    std::vector<BucketEntry> entries;
+    for (std::size_t target = 0; target < targets.size(); ++target) {
+        search.NewSearch();
+        search.State(targets[target]).g_value = 0.0;
+        search.OpenList().Push(targets[target], 0.0);
+        int node;
+        while (!search.OpenList().Empty()) {
+            if (UpwardStep(search, node)) {
+                entries.push_back({ node, (int)target, search.State(node).g_value });
+            }
+        }
+    }
+    // Group the entries by node, with the first entry of each node's bucket as its parent in bucket_index
+    std::sort(entries.begin(), entries.end(),
+              [](const BucketEntry &a, const BucketEntry &b) { return a.node < b.node; });
+    bucket_index.NewSearch();
+    for (int entry = entries.size() - 1; entry >= 0; --entry) {
+        bucket_index.State(entries[entry].node).parent = entry;
+    }
+
+    // Search up from each source; the shortest path to a target goes through the highest node on it,
+    //  which both searches reach, so the lowest sum over shared nodes is the distance
+    for (std::size_t source = 0; source < sources.size(); ++source) {
+        float *row = &table[source * targets.size()];
+        search.NewSearch();
+        search.State(sources[source]).g_value = 0.0;
+        search.OpenList().Push(sources[source], 0.0);
+        int node;
+        while (!search.OpenList().Empty()) {
+            if (!UpwardStep(search, node) || !bucket_index.Seen(node)) {
+                continue;
+            }
+            float distance = search.State(node).g_value;
+            for (int entry = bucket_index.State(node).parent; entry < (int)entries.size() && entries[entry].node == node;
+                 ++entry) {
+                row[entries[entry].target] = std::min(row[entries[entry].target], distance + entries[entry].distance);
+            }
+        }
+    }
+}
+
+void ContractionHierarchy::UnpackForward(SearchScratch &forward, int node, std::vector<int> &path) const {
+    int edge = forward.State(node).parent;
+    if (edge == SearchScratch::NO_PARENT) {
+        return;
+    }
+    int previous = Other(edges_[edge], node);
+    UnpackForward(forward, previous, path);
+    UnpackEdge(edge, previous, path);
+}
+
+void ContractionHierarchy::UnpackEdge(int edge, int from, std::vector<int> &path) const {
+    const Edge &unpacking = edges_[edge];
+    if (unpacking.middle == NONE) {
+        path.emplace_back(Other(unpacking, from));
+        return;
+    }
+    // Go through the middle node, in whichever direction the edge is traversed
+    if (from == unpacking.a) {
+        UnpackEdge(unpacking.child_a, from, path);
+        UnpackEdge(unpacking.child_b, unpacking.middle, path);
+    } else {
+        UnpackEdge(unpacking.child_b, from, path);
+        UnpackEdge(unpacking.child_a, unpacking.middle, path);
+    }
+}
+
+bool ContractionHierarchy::Write(const std::string &path) const {
+    std::ofstream out{path, std::ios::binary | std::ios::trunc};
+    if (!out) {
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.fingerprint = fingerprint_;
+    header.node_count = upward_offsets_.size() - 1;
+    header.edge_count = edges_.size();
+    header.road_edge_count = road_edge_count_;
+    header.upward_count = upward_edges_.size();
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(edges_.data()), edges_.size() * sizeof(Edge));
+    out.write(reinterpret_cast<const char *>(upward_offsets_.data()), upward_offsets_.size() * sizeof(std::int32_t));
+    out.write(reinterpret_cast<const char *>(upward_targets_.data()), upward_targets_.size() * sizeof(std::int32_t));
+    out.write(reinterpret_cast<const char *>(upward_weights_.data()), upward_weights_.size() * sizeof(float));
+    out.write(reinterpret_cast<const char *>(upward_edges_.data()), upward_edges_.size() * sizeof(std::int32_t));
+
+    return static_cast<bool>(out);
+}
+
+std::unique_ptr<ContractionHierarchy> ContractionHierarchy::Read(const RouteModel &model, const std::string &path) {
+    std::ifstream in{path, std::ios::binary | std::ios::ate};
+    if (!in) {
+        return nullptr;
+    }
+    std::size_t file_size = in.tellg();
+    in.seekg(0);
+    Header header{};
+    if (file_size < sizeof(Header) || !in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.node_count != model.SNodes().size() || header.fingerprint != Fingerprint(model)) {
+        return nullptr;
+    }
+
+    // Check the sections add up to the file size before allocating anything for them
+    std::size_t expected_size = sizeof(Header) + (header.edge_count * sizeof(Edge)) +
+        ((header.node_count + 1) * sizeof(std::int32_t)) +
+        (header.upward_count * (2 * sizeof(std::int32_t) + sizeof(float)));
+    if (expected_size != file_size || header.road_edge_count > header.edge_count) {
+        return nullptr;
+    }
+
+    std::unique_ptr<ContractionHierarchy> hierarchy(new ContractionHierarchy());
+    hierarchy->fingerprint_ = header.fingerprint;
+    hierarchy->road_edge_count_ = header.road_edge_count;
+    hierarchy->edges_.resize(header.edge_count);
+    hierarchy->upward_offsets_.resize(header.node_count + 1);
+    hierarchy->upward_targets_.resize(header.upward_count);
+    hierarchy->upward_weights_.resize(header.upward_count);
+    hierarchy->upward_edges_.resize(header.upward_count);
+    in.read(reinterpret_cast<char *>(hierarchy->edges_.data()), header.edge_count * sizeof(Edge));
+    in.read(reinterpret_cast<char *>(hierarchy->upward_offsets_.data()), (header.node_count + 1) * sizeof(std::int32_t));
+    in.read(reinterpret_cast<char *>(hierarchy->upward_targets_.data()), header.upward_count * sizeof(std::int32_t));
+    in.read(reinterpret_cast<char *>(hierarchy->upward_weights_.data()), header.upward_count * sizeof(float));
+    in.read(reinterpret_cast<char *>(hierarchy->upward_edges_.data()), header.upward_count * sizeof(std::int32_t));
+    if (!in || !hierarchy->IndicesInRange()) {
+        return nullptr;
+    }
+    return hierarchy;
+}
+
+bool ContractionHierarchy::IndicesInRange() const {
+    int node_count = upward_offsets_.size() - 1;
+    int edge_count = edges_.size();
+    auto valid_node = [node_count](int node) { return node >= 0 && node < node_count; };
+    auto ends_are = [this](int edge, int a, int b) {
+        return (edges_[edge].a == a && edges_[edge].b == b) || (edges_[edge].a == b && edges_[edge].b == a);
+    };
+
+    for (int edge = 0; edge < edge_count; ++edge) {
+        const Edge &checking = edges_[edge];
+        if (!valid_node(checking.a) || !valid_node(checking.b)) {
+            return false;
+        }
+        if (checking.middle == NONE) {
+            continue;
+        }
+        // A shortcut's halves are added before it, and join its ends through its middle node
+        if (edge < road_edge_count_ || !valid_node(checking.middle) ||
+            checking.child_a < 0 || checking.child_a >= edge || checking.child_b < 0 || checking.child_b >= edge ||
+            !ends_are(checking.child_a, checking.a, checking.middle) ||
+            !ends_are(checking.child_b, checking.middle, checking.b)) {
+            return false;
+        }
+    }
+
+    if (upward_offsets_.front() != 0 || upward_offsets_.back() != (std::int32_t)upward_targets_.size() ||
+        !std::is_sorted(upward_offsets_.begin(), upward_offsets_.end())) {
+        return false;
+    }
+    for (int node = 0; node < node_count; ++node) {
+        for (int upward = upward_offsets_[node]; upward < upward_offsets_[node + 1]; ++upward) {
+            int edge = upward_edges_[upward];
+            if (!valid_node(upward_targets_[upward]) || edge < 0 || edge >= edge_count ||
+                !ends_are(edge, node, upward_targets_[upward])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace rideshare
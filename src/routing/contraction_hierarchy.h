@@ -0,0 +1,116 @@
+/**
+ * @file contraction_hierarchy.h
+ * @brief Contraction Hierarchies preprocessing of the road graph, for fast shortest path queries.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef CONTRACTION_HIERARCHY_H_
+#define CONTRACTION_HIERARCHY_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "search_scratch.h"
+#include "mapping/route_model.h"
+
+namespace rideshare {
+
+// Nodes are contracted one at a time, least important first, adding shortcut edges between
+//  their remaining neighbors wherever the node was on the only shortest path between them.
+//  A query then only needs to search upward (toward later contracted nodes) from both ends.
+class ContractionHierarchy {
+  public:
+    // Bump whenever the file layout or the contraction changes
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr int NONE = -1;
+
+    // Constructors / Destructors
+    // Contract every node of the model's road graph
+    ContractionHierarchy(const RouteModel &model);
+
+    // Read a hierarchy written by Write, or nullptr if missing, invalid or built from a different road graph
+    static std::unique_ptr<ContractionHierarchy> Read(const RouteModel &model, const std::string &path);
+    // Write the hierarchy to a binary file
+    bool Write(const std::string &path) const;
+
+    // Getters
+    int ShortcutCount() const { return edges_.size() - road_edge_count_; }
+
+    // Primary functionality
+    // Fill path with the shortest path of node indices from start to end (empty if unreachable),
+    //  the same path A* Search finds; needs a scratch space for each search direction
+    void Query(int start_idx, int end_idx, SearchScratch &forward, SearchScratch &backward,
+               std::vector<int> &path) const;
+    // Fill table (row-major, a row per source) with the road distance from each source node to each target node,
+    //  or the max float if unreachable. One upward search per target leaves its distance in a bucket at each node
+    //  reached, then one upward search per source meets those buckets; needs a scratch space for each
+    void DistanceTable(const std::vector<int> &sources, const std::vector<int> &targets, SearchScratch &search,
+                       SearchScratch &bucket_index, std::vector<float> &table) const;
+
+  private:
+    // A road segment, or a shortcut through an earlier contracted middle node
+    struct Edge {
+        std::int32_t a, b; // end nodes
+        float weight;
+        std::int32_t middle; // NONE for road segments
+        std::int32_t child_a, child_b; // shortcut halves from a to middle, and middle to b
+    };
+
+    // Distance from a node up to a target, for DistanceTable
+    struct BucketEntry {
+        int node;
+        int target;
+        float distance;
+    };
+
+    // Fixed-size start of the file; edges and the upward graph follow in order
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+        std::uint64_t fingerprint; // of the road graph the hierarchy was built from
+        std::uint64_t node_count;
+        std::uint64_t edge_count;
+        std::uint64_t road_edge_count;
+        std::uint64_t upward_count;
+    };
+
+    // Used by Read only
+    ContractionHierarchy() {};
+
+    // Hash of the model's road graph, so a stale file is never used
+    static std::uint64_t Fingerprint(const RouteModel &model);
+    // Order nodes and add shortcuts, filling the upward graph
+    void Contract(const RouteModel &model);
+    // Run one step of a search direction, updating the best meeting node
+    void SearchStep(SearchScratch &side, SearchScratch &other, float &best, int &meet) const;
+    // Settle the next node of an upward search as node, relaxing its upward edges; false if it was stalled
+    //  (so no shortest path goes up through it)
+    bool UpwardStep(SearchScratch &side, int &node) const;
+    // Append the road nodes of an edge traversed from the given node, excluding that node
+    void UnpackEdge(int edge, int from, std::vector<int> &path) const;
+    // Append the path from the forward search start up to the given node, excluding the start
+    void UnpackForward(SearchScratch &forward, int node, std::vector<int> &path) const;
+    int Other(const Edge &edge, int node) const { return (edge.a == node) ? edge.b : edge.a; }
+    // Check every node and edge index read from a file points inside the hierarchy, and that shortcuts
+    //  only unpack into earlier edges (so unpacking always ends)
+    bool IndicesInRange() const;
+
+    std::uint64_t fingerprint_ = 0;
+    int road_edge_count_ = 0; // first edges are road segments, the rest shortcuts
+    std::vector<Edge> edges_;
+    // Upward graph in compressed sparse row form; edges from node i to later contracted nodes are
+    //  those from upward_offsets_[i] up to (not including) upward_offsets_[i + 1]
+    std::vector<std::int32_t> upward_offsets_;
+    std::vector<std::int32_t> upward_targets_;
+    std::vector<float> upward_weights_;
+    std::vector<std::int32_t> upward_edges_; // index into edges_, for unpacking
+};
+
+}  // namespace rideshare
+
+#endif  // CONTRACTION_HIERARCHY_H_
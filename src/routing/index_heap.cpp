@@ -0,0 +1,90 @@
+/**
+ * @file index_heap.cpp
+ * @brief Implementation of an indexed binary min-heap with decrease-key.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "index_heap.h"
+
+namespace rideshare {
+
+void IndexHeap::Resize(int capacity) {
+    heap_.clear();
+    heap_.reserve(capacity);
+    positions_.assign(capacity, NOT_IN_HEAP_);
+}
+
+void IndexHeap::Push(int idx, float key) {
+    heap_.emplace_back(Entry{key, idx});
+    positions_[idx] = heap_.size() - 1;
+    SiftUp(heap_.size() - 1);
+}
+
+void IndexHeap::DecreaseKey(int idx, float key) {
+    std::size_t pos = positions_[idx];
+    heap_[pos].key = key;
+    SiftUp(pos);
+}
+
+int IndexHeap::Pop() {
+    int top = heap_.front().idx;
+    positions_[top] = NOT_IN_HEAP_;
+    // Move the last entry to the front and let it sink back into place
+    Entry last = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) {
+        Place(0, last);
+        SiftDown(0);
+    }
+    return top;
+}
+
+void IndexHeap::Clear() {
+    for (const Entry &entry : heap_) {
+        positions_[entry.idx] = NOT_IN_HEAP_;
+    }
+    heap_.clear();
+}
+
+void IndexHeap::SiftUp(std::size_t pos) {
+    Entry entry = heap_[pos];
+    while (pos > 0) {
+        std::size_t parent = (pos - 1) / 2;
+        if (heap_[parent].key <= entry.key) {
+            break;
+        }
+        Place(pos, heap_[parent]);
+        pos = parent;
+    }
+    Place(pos, entry);
+}
+
+void IndexHeap::SiftDown(std::size_t pos) {
+    Entry entry = heap_[pos];
+    std::size_t size = heap_.size();
+    while (true) {
+        std::size_t child = (2 * pos) + 1;
+        if (child >= size) {
+            break;
+        }
+        // Use the smaller of the two children
+        if (child + 1 < size && heap_[child + 1].key < heap_[child].key) {
+            ++child;
+        }
+        if (entry.key <= heap_[child].key) {
+            break;
+        }
+        Place(pos, heap_[child]);
+        pos = child;
+    }
+    Place(pos, entry);
+}
+
+void IndexHeap::Place(std::size_t pos, const Entry &entry) {
+    heap_[pos] = entry;
+    positions_[entry.idx] = pos;
+}
+
+}  // namespace rideshare
@@ -0,0 +1,60 @@
+/**
+ * @file index_heap.h
+ * @brief Indexed binary min-heap of node indices, supporting decrease-key for the A* Search open list.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef INDEX_HEAP_H_
+#define INDEX_HEAP_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace rideshare {
+
+class IndexHeap {
+  public:
+    // Constructors / Destructors
+    IndexHeap() {};
+    IndexHeap(int capacity) { Resize(capacity); }
+
+    // Getters / Setters
+    // Set the number of indices (i.e. map nodes) the heap can hold; clears the heap
+    void Resize(int capacity);
+    bool Empty() const { return heap_.empty(); }
+    std::size_t Size() const { return heap_.size(); }
+    bool Contains(int idx) const { return positions_[idx] != NOT_IN_HEAP_; }
+    float TopKey() const { return heap_.front().key; }
+
+    // Primary functionality
+    // Add an index not yet in the heap with the given key
+    void Push(int idx, float key);
+    // Lower the key of an index already in the heap
+    void DecreaseKey(int idx, float key);
+    // Remove and return the index with the lowest key
+    int Pop();
+    // Remove all indices, only touching those still in the heap
+    void Clear();
+
+  private:
+    struct Entry {
+        float key;
+        int idx;
+    };
+
+    // Move the entry at a heap position up or down until heap order is restored
+    void SiftUp(std::size_t pos);
+    void SiftDown(std::size_t pos);
+    // Place an entry at a heap position, updating its stored position
+    void Place(std::size_t pos, const Entry &entry);
+
+    static constexpr int NOT_IN_HEAP_ = -1;
+    std::vector<Entry> heap_;    // binary heap of entries, lowest key at the front
+    std::vector<int> positions_; // heap position of each index, or NOT_IN_HEAP_
+};
+
+}  // namespace rideshare
+
+#endif  // INDEX_HEAP_H_
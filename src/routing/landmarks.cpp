@@ -0,0 +1,75 @@
+/**
+ * @file landmarks.cpp
+ * @brief Implementation of choosing landmarks and finding road distances from them.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "landmarks.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace rideshare {
+
+Landmarks::Landmarks(const RouteModel &model, int count) {
+    int node_count = model.SNodes().size();
+    SearchScratch scratch(node_count);
+    std::vector<float> distances(node_count);
+    // Closest distance from each node to any landmark chosen so far
+    std::vector<float> nearest_landmark(node_count, std::numeric_limits<float>::max());
+
+    // Start from the node farthest from one near the middle of the map, then keep adding the node
+    //  farthest from all landmarks so far, which spreads them around the edges of the map
+    Coordinate middle = { .x = (model.MinLon() + model.MaxLon()) / 2, .y = (model.MinLat() + model.MaxLat()) / 2 };
+    FindDistances(model, model.FindClosestNode(middle).Index(), scratch, distances);
+    int next = std::max_element(distances.begin(), distances.end()) - distances.begin();
+
+    std::vector<std::vector<float>> landmark_distances;
+    while ((int)landmarks_.size() < count) {
+        FindDistances(model, next, scratch, distances);
+        landmarks_.emplace_back(next);
+        landmark_distances.emplace_back(distances);
+        // Only nodes reached (i.e. in the same component) are candidates for the next landmark
+        float farthest = 0.0;
+        for (int node_idx = 0; node_idx < node_count; ++node_idx) {
+            if (!scratch.Seen(node_idx)) {
+                continue;
+            }
+            nearest_landmark[node_idx] = std::min(nearest_landmark[node_idx], distances[node_idx]);
+            if (nearest_landmark[node_idx] > farthest) {
+                farthest = nearest_landmark[node_idx];
+                next = node_idx;
+            }
+        }
+        // Stop early on tiny maps with fewer distinct far away nodes than landmarks asked for
+        if (farthest == 0.0) {
+            break;
+        }
+    }
+
+    // Store by node, so all of a node's distances are read together
+    distances_.resize(node_count * landmarks_.size());
+    for (int node_idx = 0; node_idx < node_count; ++node_idx) {
+        for (std::size_t i = 0; i < landmarks_.size(); ++i) {
+            distances_[(node_idx * landmarks_.size()) + i] = landmark_distances[i][node_idx];
+        }
+    }
+}
+
+void Landmarks::FindDistances(const RouteModel &model, int source, SearchScratch &scratch, std::vector<float> &distances) {
+    std::fill(distances.begin(), distances.end(), 0.0);
+    scratch.NewSearch();
+    scratch.Dijkstra(source, [&model](int node_idx, auto relax) {
+        for (int edge = model.EdgeOffsets()[node_idx]; edge < model.EdgeOffsets()[node_idx + 1]; ++edge) {
+            relax(model.EdgeTargets()[edge], model.EdgeLengths()[edge]);
+        }
+    }, [&distances](int node_idx, float distance) {
+        distances[node_idx] = distance;
+        return true;
+    });
+}
+
+}  // namespace rideshare
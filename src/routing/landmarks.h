@@ -0,0 +1,56 @@
+/**
+ * @file landmarks.h
+ * @brief Road distances from a few landmark nodes, giving lower bounds for the A* Search heuristic (ALT).
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef LANDMARKS_H_
+#define LANDMARKS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "search_scratch.h"
+#include "mapping/route_model.h"
+
+namespace rideshare {
+
+class Landmarks {
+  public:
+    static constexpr int DEFAULT_COUNT = 16;
+
+    // Constructors / Destructors
+    // Pick landmarks spread around the edges of the main component, and find road distances from each
+    Landmarks(const RouteModel &model, int count = DEFAULT_COUNT);
+
+    // Getters
+    int Count() const { return landmarks_.size(); }
+    const std::vector<int> &Nodes() const { return landmarks_; }
+
+    // Primary functionality
+    // Lower bound on the road distance between two nodes of the same component, from the triangle
+    //  inequality: a route can't be shorter than the difference in their distances to any landmark
+    float LowerBound(int node_idx, int other_idx) const {
+        const float *node_distances = &distances_[node_idx * landmarks_.size()];
+        const float *other_distances = &distances_[other_idx * landmarks_.size()];
+        float bound = 0.0;
+        for (std::size_t i = 0; i < landmarks_.size(); ++i) {
+            bound = std::max(bound, std::abs(other_distances[i] - node_distances[i]));
+        }
+        return bound;
+    }
+
+  private:
+    // Dijkstra from a landmark over the road graph, filling distance to every node reached
+    void FindDistances(const RouteModel &model, int source, SearchScratch &scratch, std::vector<float> &distances);
+
+    std::vector<int> landmarks_; // node indices
+    std::vector<float> distances_; // per node, the distance to each landmark (0 if not reached)
+};
+
+}  // namespace rideshare
+
+#endif  // LANDMARKS_H_
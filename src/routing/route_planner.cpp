@@ -10,109 +10,328 @@
 #include "route_planner.h"
 
 #include <algorithm>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <utility>
 
 #include "mapping/route_model.h"
 #include "map_object/map_object.h"
 
 namespace rideshare {
 
-// Calculate H Value (in this case, distance) for A* Search
-float RoutePlanner::CalculateHValue(RouteModel::Node const *node) {
-    return node->Distance(*end_node_);
+// Take a free scratch space, only locking long enough to touch the pool
+std::unique_ptr<SearchScratch> RoutePlanner::AcquireScratch() {
+    std::unique_lock<std::mutex> lck(scratch_pool_mtx_);
+    if (scratch_pool_.empty()) {
+        lck.unlock();
+        return std::make_unique<SearchScratch>(model_.SNodes().size());
+    }
+    std::unique_ptr<SearchScratch> scratch = std::move(scratch_pool_.back());
+    scratch_pool_.pop_back();
+    return scratch;
 }
 
-// Expand the current node by adding all unvisited neighbors to the open list
-void RoutePlanner::AddNeighbors(RouteModel::Node *current_node) {
-    // Find all of node's neighbors
-    current_node->FindNeighbors();
-    // Loop through all neighbors
-    for (auto node: current_node->neighbors_) {
-        // Set parent, h_value and g_value
-        node->parent_ = current_node;
-        node->h_value_ = CalculateHValue(node);
-        node->g_value_ = current_node->g_value_ + node->Distance(*current_node); // Current node g + how far from current
-        // Add to open list and mark as visited
-        this->open_list_.emplace_back(node);
-        node->visited_ = true;
+// Return a scratch space for later searches
+void RoutePlanner::ReleaseScratch(std::unique_ptr<SearchScratch> scratch) {
+    std::lock_guard<std::mutex> lck(scratch_pool_mtx_);
+    scratch_pool_.emplace_back(std::move(scratch));
+}
+
+// Calculate H Value (in this case, a lower bound on the distance) for A* Search
+float RoutePlanner::CalculateHValue(const RouteModel::Node &node, const RouteModel::Node &end_node) {
+    float h_value = node.Distance(end_node);
+    // Both are lower bounds, so the higher one is still never more than the true distance
+    if (landmarks_ != nullptr) {
+        h_value = std::max(h_value, landmarks_->LowerBound(node.Index(), end_node.Index()));
     }
+    return h_value;
 }
 
-// Helper function for NextNode to sort
-bool RoutePlanner::Compare(RouteModel::Node* node1, RouteModel::Node* node2) {
-    // Compare by h+g values
-    return (node1->g_value_ + node1->h_value_) > (node2->g_value_ + node2->h_value_);
+// Expand the current node by adding unseen neighbors to the open list, or lowering their cost if already open
+void RoutePlanner::AddNeighbors(SearchScratch &scratch, const RouteModel::Node &current_node,
+                                const RouteModel::Node &end_node) {
+    IndexHeap &open_list = scratch.OpenList();
+    float current_g_value = scratch.State(current_node.Index()).g_value;
+    const std::vector<int> &edge_targets = model_.EdgeTargets();
+    const std::vector<float> &edge_lengths = model_.EdgeLengths();
+    // Loop through all neighbors along the road graph edges of the node
+    int edges_end = model_.EdgeOffsets()[current_node.Index() + 1];
+    for (int edge = model_.EdgeOffsets()[current_node.Index()]; edge < edges_end; ++edge) {
+        int neighbor_idx = edge_targets[edge];
+        if (scratch.Closed(neighbor_idx)) {
+            continue;
+        }
+        SearchScratch::NodeState &state = scratch.State(neighbor_idx);
+        float g_value = current_g_value + edge_lengths[edge]; // Current node g + how far from current
+        bool in_open_list = open_list.Contains(neighbor_idx);
+        // Skip if already reached with a path at least as short
+        if (in_open_list && g_value >= state.g_value) {
+            continue;
+        }
+        // Set parent, h_value and g_value
+        state.parent = current_node.Index();
+        state.g_value = g_value;
+        if (in_open_list) {
+            open_list.DecreaseKey(neighbor_idx, state.g_value + state.h_value);
+        } else {
+            state.h_value = CalculateHValue(model_.SNodes()[neighbor_idx], end_node);
+            open_list.Push(neighbor_idx, state.g_value + state.h_value);
+        }
+    }
 }
 
 // Get next node (lowest sum) in open list
-RouteModel::Node *RoutePlanner::NextNode() {
-    // Sort the nodes in open_list
-    std::sort(open_list_.begin(), open_list_.end(), Compare);
-    // Grab the lowest sum pointer from the back of open_list, then remove it
-    auto current = open_list_.back();
-    open_list_.pop_back();
-
-    return current;
+const RouteModel::Node &RoutePlanner::NextNode(SearchScratch &scratch) {
+    // Pop the lowest sum node from the open list, and mark it as closed
+    int current_idx = scratch.OpenList().Pop();
+    scratch.State(current_idx).closed = true;
+
+    return model_.SNodes()[current_idx];
 }
 
 // Construct a final path based on result of A* Search
-std::vector<Model::Node> RoutePlanner::ConstructFinalPath(RouteModel::Node *current_node) {
-    // Create path_found vector
-    std::vector<Model::Node> path_found;
-    
+void RoutePlanner::ConstructFinalPath(SearchScratch &scratch, int end_idx, std::vector<int> &path) {
     // Iterate until a node has no parent
-    RouteModel::Node follow_node = *current_node;
-    path_found.emplace_back(follow_node); // Add initial node to path_found
-    while (follow_node.parent_ != nullptr) {
-        // Update the follow_node to the parent
-        follow_node = *(follow_node.parent_);
-        // Add the node to path_found
-        path_found.emplace_back(follow_node);
+    for (int idx = end_idx; idx != SearchScratch::NO_PARENT; idx = scratch.State(idx).parent) {
+        // Add the node index to the path
+        path.emplace_back(idx);
     }
 
-    // Reverse the path_found for proper ordering
-    std::reverse(path_found.begin(), path_found.end());
-
-    return path_found;
+    // Reverse the path for proper ordering
+    std::reverse(path.begin(), path.end());
 }
 
 // A* Search Algorithm
 void RoutePlanner::AStarSearch(std::shared_ptr<MapObject> map_obj) {
-    RouteModel::Node *current_node = nullptr;
-
-    // Get map_obj starting and destination positions
-    auto start_pos = map_obj->GetPosition();
-    auto dest_pos = map_obj->GetDestination();
+    // Route between map_obj starting and destination positions
+    AStarSearch(map_obj->GetPosition(), map_obj->GetDestination(), map_obj->PathBuffer());
+}
 
-    // Lock down the route planner until this returns
-    std::lock_guard<std::mutex> lck(mtx_);
+void RoutePlanner::AStarSearch(const Coordinate &start_pos, const Coordinate &dest_pos, std::vector<int> &path) {
+    path.clear();
 
     // Use FindClosestNode to find the closest nodes to the starting and ending coordinates.
     //  and store the nodes found
-    this->start_node_ = &model_.FindClosestNode(start_pos);
-    this->end_node_ = &model_.FindClosestNode(dest_pos);
+    const RouteModel::Node &start_node = model_.FindClosestNode(start_pos);
+    const RouteModel::Node &end_node = model_.FindClosestNode(dest_pos);
+    // Both snap to the main component, so a route between them always exists
+
+    // Search upward from both ends of the hierarchy, if there is one
+    if (hierarchy_ != nullptr) {
+        std::unique_ptr<SearchScratch> forward = AcquireScratch();
+        std::unique_ptr<SearchScratch> backward = AcquireScratch();
+        hierarchy_->Query(start_node.Index(), end_node.Index(), *forward, *backward, path);
+        ReleaseScratch(std::move(forward));
+        ReleaseScratch(std::move(backward));
+        return;
+    }
+
+    if (bidirectional_) {
+        BidirectionalSearch(start_node, end_node, path);
+        return;
+    }
+
+    // Get scratch space for this search only, invalidating any node states from its previous search
+    std::unique_ptr<SearchScratch> scratch = AcquireScratch();
+    scratch->NewSearch();
 
     // Add start node to open list
-    start_node_->visited_ = true;
-    open_list_.emplace_back(start_node_);
+    SearchScratch::NodeState &start_state = scratch->State(start_node.Index());
+    start_state.g_value = 0.0;
+    start_state.h_value = CalculateHValue(start_node, end_node);
+    scratch->OpenList().Push(start_node.Index(), start_state.h_value);
 
     // Loop while not at goal and can expand nodes
-    while (open_list_.size() > 0) {
+    while (!scratch->OpenList().Empty()) {
         // Get the next node
-        current_node = NextNode();
+        const RouteModel::Node &current_node = NextNode(*scratch);
         // Check if at the goal state, and if so, construct the final path
-        if (current_node->x == end_node_->x && current_node->y == end_node_->y) {
-            map_obj->SetPath(ConstructFinalPath(current_node));
+        if (current_node.x == end_node.x && current_node.y == end_node.y) {
+            ConstructFinalPath(*scratch, current_node.Index(), path);
             break; // Can stop searching
         }
         // Add all neighbors for current node
-        AddNeighbors(current_node);
+        AddNeighbors(*scratch, current_node, end_node);
     }
 
-    // Reset the open list and model nodes
-    open_list_.clear();
-    model_.ResetNodes();
+    ReleaseScratch(std::move(scratch));
+}
+
+void RoutePlanner::SearchRoads(SearchScratch &scratch, int start_idx, const std::function<bool(int, float)> &settle) {
+    scratch.Dijkstra(start_idx, [this](int node_idx, auto relax) {
+        int edges_end = model_.EdgeOffsets()[node_idx + 1];
+        for (int edge = model_.EdgeOffsets()[node_idx]; edge < edges_end; ++edge) {
+            relax(model_.EdgeTargets()[edge], model_.EdgeLengths()[edge]);
+        }
+    }, settle);
+}
+
+// One-to-many Dijkstra search, settling nodes in order of road distance from the start
+void RoutePlanner::RoadDistances(int start_idx, const std::vector<int> &targets, std::vector<float> &distances,
+                                 int max_reached) {
+    distances.assign(targets.size(), UNREACHABLE);
+    std::unique_ptr<SearchScratch> scratch = AcquireScratch();
+    scratch->NewSearch();
+
+    // Mark the nodes of targets in the same component, which the search is sure to reach if not stopped early;
+    //  (node, target) pairs are sorted so all targets at a node are found together
+    std::vector<std::pair<int, int>> target_nodes;
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        if (model_.Connected(start_idx, targets[i])) {
+            target_nodes.emplace_back(targets[i], i);
+            scratch->Mark(targets[i]);
+        }
+    }
+    std::sort(target_nodes.begin(), target_nodes.end());
+    max_reached = std::min(max_reached, (int)target_nodes.size());
+
+    int reached = 0;
+    if (max_reached > 0) {
+        SearchRoads(*scratch, start_idx, [&](int node_idx, float distance) {
+            if (scratch->Marked(node_idx)) {
+                auto target = std::lower_bound(target_nodes.begin(), target_nodes.end(), std::pair{node_idx, 0});
+                for (; target != target_nodes.end() && target->first == node_idx; ++target) {
+                    distances[target->second] = distance;
+                    ++reached;
+                }
+            }
+            return reached < max_reached;
+        });
+    }
+
+    ReleaseScratch(std::move(scratch));
+}
+
+// Dijkstra search stopping at the first target settled, so any nearer node has already been checked
+int RoutePlanner::NearestRoadNode(int start_idx, const std::function<bool(int)> &is_target) {
+    std::unique_ptr<SearchScratch> scratch = AcquireScratch();
+    scratch->NewSearch();
+    int nearest = NOT_FOUND;
+    SearchRoads(*scratch, start_idx, [&is_target, &nearest](int node_idx, float) {
+        if (is_target(node_idx)) {
+            nearest = node_idx;
+            return false;
+        }
+        return true;
+    });
+    ReleaseScratch(std::move(scratch));
+    return nearest;
+}
+
+// Many-to-many road distances
+void RoutePlanner::DistanceTable(const std::vector<int> &sources, const std::vector<int> &targets,
+                                 std::vector<float> &table) {
+    if (hierarchy_ != nullptr) {
+        std::unique_ptr<SearchScratch> search = AcquireScratch();
+        std::unique_ptr<SearchScratch> bucket_index = AcquireScratch();
+        hierarchy_->DistanceTable(sources, targets, *search, *bucket_index, table);
+        ReleaseScratch(std::move(search));
+        ReleaseScratch(std::move(bucket_index));
+        return;
+    }
+
+    table.resize(sources.size() * targets.size());
+    std::vector<float> row;
+    for (std::size_t source = 0; source < sources.size(); ++source) {
+        RoadDistances(sources[source], targets, row, targets.size());
+        std::copy(row.begin(), row.end(), table.begin() + (source * targets.size()));
+    }
+}
+
+// Bidirectional A* Search, with each direction using half the difference of the h-values toward either end,
+//  so both see the same edge costs (length less potential change) and can stop like bidirectional Dijkstra
+void RoutePlanner::BidirectionalSearch(const RouteModel::Node &start_node, const RouteModel::Node &end_node,
+                                       std::vector<int> &path) {
+    std::unique_ptr<SearchScratch> forward = AcquireScratch();
+    std::unique_ptr<SearchScratch> backward = AcquireScratch();
+    forward->NewSearch();
+    backward->NewSearch();
+
+    // Add each end to its direction's open list, with h_value holding the potential
+    SearchScratch::NodeState &start_state = forward->State(start_node.Index());
+    start_state.g_value = 0.0;
+    start_state.h_value = (CalculateHValue(start_node, end_node) - CalculateHValue(start_node, start_node)) / 2;
+    forward->OpenList().Push(start_node.Index(), start_state.h_value);
+    SearchScratch::NodeState &end_state = backward->State(end_node.Index());
+    end_state.g_value = 0.0;
+    end_state.h_value = (CalculateHValue(end_node, start_node) - CalculateHValue(end_node, end_node)) / 2;
+    backward->OpenList().Push(end_node.Index(), end_state.h_value);
+
+    // Expand the direction with the lower key, until no path through either open list can be shorter.
+    //  If either open list runs out, its side of the graph is fully searched, so the best is final
+    float best = std::numeric_limits<float>::max();
+    int meet_forward = SearchScratch::NO_PARENT;
+    int meet_backward = SearchScratch::NO_PARENT;
+    while (!forward->OpenList().Empty() && !backward->OpenList().Empty() &&
+           forward->OpenList().TopKey() + backward->OpenList().TopKey() < best) {
+        if (forward->OpenList().TopKey() <= backward->OpenList().TopKey()) {
+            BidirectionalStep(*forward, *backward, true, end_node, start_node, best, meet_forward, meet_backward);
+        } else {
+            BidirectionalStep(*backward, *forward, false, start_node, end_node, best, meet_forward, meet_backward);
+        }
+    }
+
+    // Join the forward path to the meeting point with the backward path from it
+    if (meet_forward != SearchScratch::NO_PARENT) {
+        ConstructFinalPath(*forward, meet_forward, path);
+        if (meet_backward != meet_forward) {
+            path.emplace_back(meet_backward);
+        }
+        for (int idx = backward->State(meet_backward).parent; idx != SearchScratch::NO_PARENT;
+             idx = backward->State(idx).parent) {
+            path.emplace_back(idx);
+        }
+    }
+
+    ReleaseScratch(std::move(forward));
+    ReleaseScratch(std::move(backward));
+}
+
+void RoutePlanner::BidirectionalStep(SearchScratch &side, SearchScratch &other, bool forward,
+                                     const RouteModel::Node &side_end, const RouteModel::Node &other_end,
+                                     float &best, int &meet_forward, int &meet_backward) {
+    // A path through a node or edge reached from both ends may be the shortest
+    auto update_best = [&](int side_idx, int other_idx, float length) {
+        if (length < best) {
+            best = length;
+            meet_forward = forward ? side_idx : other_idx;
+            meet_backward = forward ? other_idx : side_idx;
+        }
+    };
+
+    const RouteModel::Node &current_node = NextNode(side);
+    float current_g_value = side.State(current_node.Index()).g_value;
+    if (other.Seen(current_node.Index())) {
+        update_best(current_node.Index(), current_node.Index(), current_g_value + other.State(current_node.Index()).g_value);
+    }
+
+    int edges_end = model_.EdgeOffsets()[current_node.Index() + 1];
+    for (int edge = model_.EdgeOffsets()[current_node.Index()]; edge < edges_end; ++edge) {
+        int neighbor_idx = model_.EdgeTargets()[edge];
+        if (side.Closed(neighbor_idx)) {
+            continue;
+        }
+        float g_value = current_g_value + model_.EdgeLengths()[edge];
+        if (other.Seen(neighbor_idx)) {
+            update_best(current_node.Index(), neighbor_idx, g_value + other.State(neighbor_idx).g_value);
+        }
+        bool in_open_list = side.OpenList().Contains(neighbor_idx);
+        SearchScratch::NodeState &state = side.State(neighbor_idx);
+        if (in_open_list && g_value >= state.g_value) {
+            continue;
+        }
+        state.parent = current_node.Index();
+        state.g_value = g_value;
+        if (in_open_list) {
+            side.OpenList().DecreaseKey(neighbor_idx, state.g_value + state.h_value);
+        } else {
+            const RouteModel::Node &neighbor = model_.SNodes()[neighbor_idx];
+            state.h_value = (CalculateHValue(neighbor, side_end) - CalculateHValue(neighbor, other_end)) / 2;
+            side.OpenList().Push(neighbor_idx, state.g_value + state.h_value);
+        }
+    }
 }
 
 }  // namespace rideshare
@@ -9,12 +9,18 @@
 #ifndef ROUTE_PLANNER_H_
 #define ROUTE_PLANNER_H_
 
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <vector>
 #include <string>
+#include <utility>
 
+#include "contraction_hierarchy.h"
+#include "landmarks.h"
+#include "search_scratch.h"
 #include "mapping/route_model.h"
 #include "map_object/map_object.h"
 
@@ -22,37 +28,74 @@ namespace rideshare {
 
 class RoutePlanner {
   public:
+    // Road distance of a target not reached by RoadDistances
+    static constexpr float UNREACHABLE = std::numeric_limits<float>::max();
+    // Node index returned by NearestRoadNode when no reachable node is a target
+    static constexpr int NOT_FOUND = -1;
+
     // Constructors / Destructors
-    RoutePlanner(RouteModel &model) : model_(model) {};
+    RoutePlanner(const RouteModel &model) : model_(model) {};
 
     // Getters / Setters
+    // Answer searches from a contraction hierarchy of the model instead (set before any searches)
+    void SetContractionHierarchy(std::unique_ptr<ContractionHierarchy> hierarchy) { hierarchy_ = std::move(hierarchy); }
+    // Tighten the A* Search heuristic with landmark distances (set before any searches)
+    void SetLandmarks(std::unique_ptr<Landmarks> landmarks) { landmarks_ = std::move(landmarks); }
+    // Search from both the start and the destination at once (set before any searches)
+    void SetBidirectional(bool bidirectional) { bidirectional_ = bidirectional; }
 
     // Primary functionality
+    // Safe to call from multiple threads at once, as each search uses its own scratch space
+    // Set the map object's path from its position to its destination (empty if unreachable)
     void AStarSearch(std::shared_ptr<MapObject> map_obj);
+    // Fill path with the indices of road nodes from the one closest to start_pos to the one closest
+    //  to dest_pos (empty if unreachable); re-uses path's memory, so a reused path does not allocate
+    void AStarSearch(const Coordinate &start_pos, const Coordinate &dest_pos, std::vector<int> &path);
+    // Fill distances with the road distance from a node to each of the target nodes, in a single Dijkstra
+    //  search outward that stops once max_reached targets are reached (so those are the nearest by road);
+    //  any other target is UNREACHABLE. Roads go both ways, so these are also distances to the node
+    void RoadDistances(int start_idx, const std::vector<int> &targets, std::vector<float> &distances, int max_reached);
+    // Search outward from a node in order of road distance, returning the first node for which is_target
+    //  is true (the nearest such node by road), or NOT_FOUND if none is reachable
+    int NearestRoadNode(int start_idx, const std::function<bool(int)> &is_target);
+    // Fill table (row-major, a row per source) with the road distance from each source node to each target node,
+    //  or UNREACHABLE; bucket searches over the contraction hierarchy if set, otherwise a RoadDistances per source
+    void DistanceTable(const std::vector<int> &sources, const std::vector<int> &targets, std::vector<float> &table);
 
   private:
-    // Route model-related variables
-    std::vector<RouteModel::Node*> open_list_;
-    RouteModel::Node *start_node_;
-    RouteModel::Node *end_node_;
-
-    // Mutex to ensure single access to certain pointers (model, nodes) during A* Search
-    std::mutex mtx_;
-
     // Other variables
-    RouteModel &model_;
+    const RouteModel &model_; // Read-only, shared by all searches
+    std::unique_ptr<ContractionHierarchy> hierarchy_; // Read-only once set, if used
+    std::unique_ptr<Landmarks> landmarks_; // Read-only once set, if used
+    bool bidirectional_ = false;
+
+    // Scratch spaces not currently in use by a search, re-used to avoid allocations
+    std::vector<std::unique_ptr<SearchScratch>> scratch_pool_;
+    // Mutex protecting only the scratch pool, not the searches themselves
+    std::mutex scratch_pool_mtx_;
 
     // Functions
-    // Sort two nodes by h+g value (used by A*)
-    static bool Compare(RouteModel::Node* node1, RouteModel::Node* node2);
-    // Add all neighbors to a given node
-    void AddNeighbors(RouteModel::Node *current_node);
-    // Calculate the h-value for a node (distance)
-    float CalculateHValue(RouteModel::Node const *node);
-    // Construct in reverse the A* Search path, giving start -> finish
-    std::vector<Model::Node> ConstructFinalPath(RouteModel::Node *);
-    // Get the next node along a given A* Search path
-    RouteModel::Node *NextNode();
+    // Take a scratch space from the pool, or create one if all are in use
+    std::unique_ptr<SearchScratch> AcquireScratch();
+    // Return a scratch space to the pool once a search is done with it
+    void ReleaseScratch(std::unique_ptr<SearchScratch> scratch);
+    // Dijkstra search over the roads from a node, calling settle(node, distance) as each node is settled
+    //  until it returns false (the scratch space's search must already be started)
+    void SearchRoads(SearchScratch &scratch, int start_idx, const std::function<bool(int, float)> &settle);
+    // Add or improve all neighbors of a given node
+    void AddNeighbors(SearchScratch &scratch, const RouteModel::Node &current_node, const RouteModel::Node &end_node);
+    // Calculate the h-value for a node (straight-line distance, or the landmark bound if higher)
+    float CalculateHValue(const RouteModel::Node &node, const RouteModel::Node &end_node);
+    // Construct in reverse the A* Search path of node indices, giving start -> finish
+    void ConstructFinalPath(SearchScratch &scratch, int end_idx, std::vector<int> &path);
+    // Get the next node along a given A* Search path, and close it
+    const RouteModel::Node &NextNode(SearchScratch &scratch);
+    // Bidirectional A* Search between two nodes, filling path (empty if unreachable)
+    void BidirectionalSearch(const RouteModel::Node &start_node, const RouteModel::Node &end_node, std::vector<int> &path);
+    // Expand the lowest key node of one direction, lowering the best path length and its meeting nodes
+    //  (last node reached from the start, and first reached from the end) if a shorter one is found
+    void BidirectionalStep(SearchScratch &side, SearchScratch &other, bool forward, const RouteModel::Node &side_end,
+                           const RouteModel::Node &other_end, float &best, int &meet_forward, int &meet_backward);
 };
 
 }  // namespace rideshare
@@ -0,0 +1,37 @@
+/**
+ * @file search_scratch.cpp
+ * @brief Implementation of lazily reset per-query A* Search state.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "search_scratch.h"
+
+#include <algorithm>
+
+namespace rideshare {
+
+SearchScratch::SearchScratch(int node_count) :
+  states_(node_count), stamps_(node_count, 0), marks_(node_count, 0), open_list_(node_count) {}
+
+SearchScratch::NodeState &SearchScratch::State(int idx) {
+    if (stamps_[idx] != generation_) {
+        states_[idx] = NodeState();
+        stamps_[idx] = generation_;
+    }
+    return states_[idx];
+}
+
+void SearchScratch::NewSearch() {
+    open_list_.Clear();
+    ++generation_;
+    if (generation_ == 0) {
+        // Wrapped around, so old stamps could look current - clear them all once
+        std::fill(stamps_.begin(), stamps_.end(), 0);
+        std::fill(marks_.begin(), marks_.end(), 0);
+        generation_ = 1;
+    }
+}
+
+}  // namespace rideshare
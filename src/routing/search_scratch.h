@@ -0,0 +1,93 @@
+/**
+ * @file search_scratch.h
+ * @brief Per-query A* Search state for map nodes, reset lazily via generation stamps,
+ * and the Dijkstra search shared by searches that only need road distances.
+ * Each concurrent search needs its own scratch space.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef SEARCH_SCRATCH_H_
+#define SEARCH_SCRATCH_H_
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "index_heap.h"
+
+namespace rideshare {
+
+class SearchScratch {
+  public:
+    // Search state of a single node
+    struct NodeState {
+        float g_value = 0.0;
+        float h_value = std::numeric_limits<float>::max();
+        int parent = NO_PARENT;
+        bool closed = false; // expanded by the search
+    };
+
+    static constexpr int NO_PARENT = -1;
+
+    // Constructors / Destructors
+    SearchScratch(int node_count);
+
+    // Getters / Setters
+    // State of a node, reset to defaults the first time it is touched in the current search
+    NodeState &State(int idx);
+    // Whether a node has been touched in the current search
+    bool Seen(int idx) const { return stamps_[idx] == generation_; }
+    bool Closed(int idx) const { return Seen(idx) && states_[idx].closed; }
+    IndexHeap &OpenList() { return open_list_; }
+    // Flag a node (such as a search target) for the current search, without touching its state
+    void Mark(int idx) { marks_[idx] = generation_; }
+    bool Marked(int idx) const { return marks_[idx] == generation_; }
+
+    // Start a new search, invalidating all node states and marks without touching them
+    void NewSearch();
+
+    // Dijkstra search from source, settling nodes in order of distance, within the current search
+    //  (so nodes can be marked first). for_each_edge(node, relax) calls relax(next, length) for each edge
+    //  to follow out of node; settle(node, distance) is called as each node is settled, before its edges,
+    //  and returns false to stop the search there
+    template <typename ForEachEdge, typename Settle>
+    void Dijkstra(int source, ForEachEdge for_each_edge, Settle settle);
+
+  private:
+    std::vector<NodeState> states_;
+    std::vector<std::uint32_t> stamps_; // generation in which each node state was last reset
+    std::vector<std::uint32_t> marks_; // generation in which each node was last marked
+    std::uint32_t generation_ = 0;
+    IndexHeap open_list_; // node indices keyed by h+g value
+};
+
+template <typename ForEachEdge, typename Settle>
+void SearchScratch::Dijkstra(int source, ForEachEdge for_each_edge, Settle settle) {
+    State(source).g_value = 0.0;
+    open_list_.Push(source, 0.0);
+    while (!open_list_.Empty()) {
+        int node = open_list_.Pop();
+        NodeState &state = State(node);
+        state.closed = true;
+        if (!settle(node, state.g_value)) {
+            return;
+        }
+        float g_value = state.g_value;
+        for_each_edge(node, [this, g_value](int next, float length) {
+            float distance = g_value + length;
+            if (!Seen(next)) {
+                State(next).g_value = distance;
+                open_list_.Push(next, distance);
+            } else if (!Closed(next) && distance < states_[next].g_value) {
+                states_[next].g_value = distance;
+                open_list_.DecreaseKey(next, distance);
+            }
+        });
+    }
+}
+
+}  // namespace rideshare
+
+#endif  // SEARCH_SCRATCH_H_
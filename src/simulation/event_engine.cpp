@@ -0,0 +1,32 @@
+/**
+ * @file event_engine.cpp
+ * @brief Implementation of the discrete-event simulation core.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#include "event_engine.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace rideshare {
+
+void EventEngine::Schedule(int64_t time, Callback callback) {
+    events_.push({ .time = std::max(time, now_), .sequence = next_sequence_++, .callback = std::move(callback) });
+}
+
+void EventEngine::RunUntil(int64_t end_time) {
+    while (!events_.empty() && events_.top().time <= end_time) {
+        // Take the event off the queue first, as its callback may schedule more events
+        Event event = std::move(const_cast<Event&>(events_.top()));
+        events_.pop();
+        now_ = event.time;
+        event.callback();
+        ++events_run_;
+    }
+    now_ = std::max(now_, end_time);
+}
+
+}  // namespace rideshare
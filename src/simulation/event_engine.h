@@ -0,0 +1,59 @@
+/**
+ * @file event_engine.h
+ * @brief Discrete-event simulation core, running timestamped events in order on a virtual clock.
+ *
+ * @copyright Copyright (c) 2021, Michael Virgo, released under the MIT License.
+ *
+ */
+
+#ifndef EVENT_ENGINE_H_
+#define EVENT_ENGINE_H_
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace rideshare {
+
+class EventEngine {
+  public:
+    using Callback = std::function<void()>;
+
+    // Getters / Setters
+    // Current virtual time in ms, i.e. the time of the event being run
+    int64_t Now() const { return now_; }
+    uint64_t EventsRun() const { return events_run_; }
+
+    // Primary functionality
+    // Run the callback at the given virtual time (never earlier than now)
+    void Schedule(int64_t time, Callback callback);
+    // Run the callback the given number of ms after now
+    void ScheduleAfter(int64_t delay, Callback callback) { Schedule(now_ + delay, std::move(callback)); }
+    // Run events in time order until none are left or the next one is after end_time, then
+    //  advance the clock to end_time. Events at the same time run in the order they were scheduled.
+    void RunUntil(int64_t end_time);
+
+  private:
+    struct Event {
+        int64_t time;
+        uint64_t sequence; // breaks ties between events at the same time, keeping runs deterministic
+        Callback callback;
+    };
+
+    // Orders the priority queue so the earliest (then first scheduled) event is on top
+    struct Later {
+        bool operator()(const Event &a, const Event &b) const {
+            return (a.time != b.time) ? (a.time > b.time) : (a.sequence > b.sequence);
+        }
+    };
+
+    std::priority_queue<Event, std::vector<Event>, Later> events_;
+    int64_t now_ = 0;
+    uint64_t next_sequence_ = 0;
+    uint64_t events_run_ = 0;
+};
+
+}  // namespace rideshare
+
+#endif  // EVENT_ENGINE_H_
@@ -9,9 +9,7 @@
 
 #include "graphics.h"
 
-#include <chrono>
 #include <memory>
-#include <thread>
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
@@ -30,10 +28,7 @@ Graphics::Graphics(float min_lat, float min_lon, float max_lat, float max_lon) {
 void Graphics::Simulate() {
     this->LoadBackgroundImg();
     while (true) {
-        // sleep at every iteration to reduce CPU usage
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-
-        // update graphics
+        // update graphics (waitKey in DrawSimulation paces the frames)
         this->DrawSimulation();
     }
 }
@@ -98,18 +93,20 @@ void Graphics::DrawPassenger(float img_rows, float img_cols, int marker_size, co
 
 void Graphics::DrawVehicles(float img_rows, float img_cols) {
     // create overlay from vehicles
-    for (auto const & [id, vehicle] : vehicle_manager_->Vehicles()) {
-        Coordinate position = vehicle->GetPosition();
+    const VehicleFleet &fleet = vehicle_manager_->Fleet();
+    auto fleet_lck = fleet.ReadLock(); // vehicles can't be added or removed while drawing
+    for (int slot = 0; slot < fleet.Size(); ++slot) {
+        Coordinate position = fleet.Position(slot);
 
         // Adjust the position based on lat & lon in image
         position.x = (position.x - min_lon_) / (max_lon_ - min_lon_);
         position.y = (max_lat_ - position.y) / (max_lat_ - min_lat_);
 
         // Set color according to vehicle and draw a marker there
-        cv::Scalar color = cv::Scalar(vehicle->Blue(), vehicle->Green(), vehicle->Red());
-        cv::drawMarker(images_.at(1), cv::Point2d((int)(position.x * img_cols), (int)(position.y * img_rows)), color, vehicle->Shape(), 25, 15);
+        cv::Scalar color = cv::Scalar(fleet.Blue(slot), fleet.Green(slot), fleet.Red(slot));
+        cv::drawMarker(images_.at(1), cv::Point2d((int)(position.x * img_cols), (int)(position.y * img_rows)), color, VehicleFleet::SHAPE, 25, 15);
         // Draw any related information for possible passenger
-        auto passenger = vehicle->GetPassenger(); // ensures shared pointer will stay alive while drawing, if it exits
+        auto passenger = fleet.GetPassenger(slot); // ensures shared pointer will stay alive while drawing, if it exits
         if (passenger != nullptr) {
             // Note that this state is guaranteed to have a passenger
             DrawPassenger(img_rows, img_cols, 15, passenger); // Smaller marker
@@ -1,4 +0,0 @@
-#!/bin/bash
-
-#Push to igagis repo for now
-pod repo push igagis pugixml.podspec --use-libraries --verbose
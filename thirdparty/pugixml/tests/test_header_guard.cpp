@@ -1,3 +0,0 @@
-// Tests header guards
-#include "../src/pugixml.hpp"
-#include "../src/pugixml.hpp"
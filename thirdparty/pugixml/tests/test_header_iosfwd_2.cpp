@@ -1,3 +0,0 @@
-// Tests compatibility with iosfwd
-#include <iosfwd>
-#include "../src/pugixml.hpp"
@@ -1,3 +0,0 @@
-// Tests compatibility with iostream
-#include "../src/pugixml.hpp"
-#include <iostream>
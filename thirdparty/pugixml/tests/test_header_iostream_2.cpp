@@ -1,3 +0,0 @@
-// Tests compatibility with iostream
-#include <iostream>
-#include "../src/pugixml.hpp"
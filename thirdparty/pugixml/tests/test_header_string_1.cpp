@@ -1,3 +0,0 @@
-// Tests compatibility with string
-#include "../src/pugixml.hpp"
-#include <string>
@@ -1,3 +0,0 @@
-// Tests compatibility with string
-#include <string>
-#include "../src/pugixml.hpp"
@@ -1,5 +0,0 @@
-// Tests compatibility with string/iostream
-#include <string>
-#include "../src/pugixml.hpp"
-#include <istream>
-#include <ostream>